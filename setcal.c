@@ -1,7 +1,30 @@
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE // syscall for hardware counters of --perf
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+#ifdef __GLIBC__
+#include <malloc.h> // malloc_trim of --max-memory
+#endif
 #include "string.h"
+#include "setcal.h"
 
 // constants for magic values
 #define FILEMODE "r"
@@ -9,10 +32,55 @@
 #define SET 'S'
 #define RELATION 'R'
 #define CALCULATE 'C'
+#define PARTITION 'P'
+#define MATRIX_TYPE 'M'
 #define SPACE " "
+#define NEGATION '~' // argument ~A stands for complement of set A
+#define SPAN "-"       // argument A-B stands for lines A, A + 1, ..., B
+#define VECTOR ".."    // argument A..B executes command for each of lines A, A + 1, ..., B
 #define MAX_LENGTH 30
-#define MAX_LINES 1000
+#define MAX_LINES 100000
 #define PAIR 2
+#define BATCH "--batch"
+#define OUTPUT_SUFFIX ".out"
+#define MAX_THREADS 16 // threads of work split between processors
+#define PARALLEL_COST (1L << 20) // operations worth a thread of their own
+#define DEGREE_SIZE 0             // phases of counting degrees by more threads
+#define DEGREE_COUNT 1
+#define DEGREE_MERGE 2
+#define DEGREE_MAX 3
+#define DEGREE_HISTOGRAM 4
+#ifdef __GNUC__
+#define THREAD_LOCAL __thread
+#else
+#define THREAD_LOCAL _Thread_local
+#endif
+#define SERVE "--serve"
+#define INCREMENTAL "--incremental"
+#define CACHE_FILE "/cache"
+#define CACHE_TEMP "/cache.tmp"
+#define CACHE_HEADER "setcal cache 2" // first line of cache file, caches of other formats are ignored
+#define BUFFER_SIZE 4096
+#define SKETCH "--sketch"
+#define SKETCH_ERROR 0.02 // relative error of sketches if it isn't given by --sketch
+#define PERF "--perf"
+#define OUTPUT "--output="
+#define OUTPUT_TEXT 0
+#define OUTPUT_IDS 1    // elements are printed as universe indexes
+#define OUTPUT_BINARY 2 // every line is printed as a frame
+#define DECODE "--decode"
+#define PERF_COUNTERS 5  // cycles, instructions, L1 data misses, last level cache misses, branch misses
+#define PERF_OPCODES 64  // phases and operations reported separately, the others are left out
+#define PERF_OUTLIERS 10 // slowest lines reported
+#define MAX_MEMORY "--max-memory"
+#define MEMORY_TOP 10 // lines using the most memory reported
+#define SMALL_SET 16 // sets up to this size are searched linearly
+#define ARRAY_CONTAINER 'a'
+#define BITMAP_CONTAINER 'b'
+#define RUN_CONTAINER 'r'
+#define CONTAINER_SIZE 65536
+#define ARRAY_LIMIT 4096 // array container with more values would be larger than bitmap
+#define CACHE_BLOCK (256 * 1024) // bytes of rows compared at once, about the size of L2 cache
 
 // constants for set commands
 #define EMPTY "empty"
@@ -35,6 +103,29 @@
 #define INJECTIVE "injective"
 #define SURJECTIVE "surjective"
 #define BIJECTIVE "bijective"
+#define REACH "reach"
+#define DISTANCE "distance"
+#define CLASSES "classes"
+#define COMPONENTS "components"
+#define POSET "poset"
+#define ACYCLIC "acyclic"
+#define TOPOSORT "toposort"
+#define MATRIX "matrix"
+#define JACCARD "jaccard"
+#define CARD_INTERSECT "card-intersect"
+#define CARD_UNION "card-union"
+#define CARD_MINUS "card-minus"
+#define APPROX_CARD "approx-card"
+#define APPROX_UNION_CARD "approx-union-card"
+#define APPROX_JACCARD "approx-jaccard"
+#define MEMBER "member"
+#define SETS_CONTAINING "sets-containing"
+#define SUCC "succ"
+#define PRED "pred"
+#define STATS "stats"
+#define TOPK_OUT "topk-out"
+#define TOPK_IN "topk-in"
+#define DENSE "dense"
 
 #define _TRUE "true"
 #define _FALSE "false"
@@ -43,9 +134,9 @@
 #define allocate(var, size) ((var = malloc(size)) == NULL)
 #define reallocate(errorPointer, var, size) ((errorPointer = realloc(var, size)) == NULL)
 
-#define RESTRICTED_COUNT 21
+#define RESTRICTED_COUNT 43
 // restricted constants
-const char *RESTRICTED[RESTRICTED_COUNT] = {
+static const char *RESTRICTED[RESTRICTED_COUNT] = {
     EMPTY,
     CARD,
     COMPLEMENT,
@@ -67,1114 +158,6775 @@ const char *RESTRICTED[RESTRICTED_COUNT] = {
     INJECTIVE,
     SURJECTIVE,
     BIJECTIVE,
+    REACH,
+    DISTANCE,
+    CLASSES,
+    COMPONENTS,
+    POSET,
+    ACYCLIC,
+    TOPOSORT,
+    MATRIX,
+    JACCARD,
+    CARD_INTERSECT,
+    CARD_UNION,
+    CARD_MINUS,
+    APPROX_CARD,
+    APPROX_UNION_CARD,
+    APPROX_JACCARD,
+    MEMBER,
+    SETS_CONTAINING,
+    SUCC,
+    PRED,
+    STATS,
+    TOPK_OUT,
+    TOPK_IN,
 };
 
-enum ERROR // error codes
+enum ERROR // error codes, the same as SETCAL_ERROR of setcal.h
 {
-    MEMORY_ERR = 1,
-    ARGS_ERR,
-    FILE_ERR
+    MEMORY_ERR = SETCAL_MEMORY_ERR,
+    ARGS_ERR = SETCAL_ARGS_ERR,
+    FILE_ERR = SETCAL_FILE_ERR
 };
-// error handler
-void ExitFailure(int error)
+
+// structures of models, setcal.h declares handles of them
+
+typedef struct // elements of set with the same upper 16 bits of universe index (Roaring bitmap container)
 {
-    printf("ERROR: ");
-    switch (error)
-    {
-    case MEMORY_ERR:
-        fprintf(stderr, "Unable to allocate more memory");
-        break;
-    case ARGS_ERR:
-        fprintf(stderr, "Invalid Arguments");
-        break;
-    case FILE_ERR:
-        fprintf(stderr, "Cannot open file");
-        break;
-    }
-    exit(error);
-}
+    uint16_t key;      // upper 16 bits of elements
+    char type;         // array of lower bits, bitmap of 2^16 bits or runs of consecutive elements
+    int cardinality;   // number of elements
+    int count;         // number of values of array or runs
+    uint16_t *values;  // array: sorted lower bits, runs: pairs of start and length - 1
+    uint64_t *bits;    // bitmap: 1024 words
+} container_t;
 
-// structures
+typedef struct // compressed bitmap of set, containers are sorted by key
+{
+    container_t *containers;
+    int count;
+} roaring_t;
 
-typedef struct // set
+typedef struct setcal_set // set
 {
     char **items;
     int numberOfItems;
+    int *ids;            // universe indexes of items
+    int *index;          // hash index of items (universe index + 1, 0 is an empty slot), built on first lookup
+    int indexCapacity;   // number of slots in index
+    uint64_t *bits;      // bitmap of ids over universe, built on first comparison of many sets
+    int *sorted;         // ids in ascending order, built on first comparison of many sets
+    uint8_t *registers;  // HyperLogLog sketch of set, built at load or on first approximate command
+    uint64_t *signature; // MinHash signature of set, built with registers
+    roaring_t *roaring;  // compressed bitmap of ids, built on first lookup in a larger set
+    uint64_t digest[2];  // fingerprint of elements, the same for the same elements in any order
+    int references;      // number of lines sharing the set
+    bool negated;        // set is the complement of its items, only results of commands over ~A are negated
+    bool borrowed;       // items point to names of universe, they aren't freed with set (--max-memory)
 } set_t;
 
-typedef struct // pair
+typedef struct // relation as a graph over universe indexes
 {
-    char elements[PAIR][MAX_LENGTH];
-} pair_t;
+    int vertices;     // number of elements of universe
+    int *outStart;    // outAdj[outStart[u]..outStart[u + 1]) are sorted successors of u
+    int *outAdj;      // successors
+    int *inStart;     // inAdj[inStart[v]..inStart[v + 1]) are sorted predecessors of v
+    int *inAdj;       // predecessors
+    int stamp;        // stamp of the last search, so marks don't have to be cleared between queries
+    int *seen[PAIR];  // stamps of elements visited from the source [0] and from the target [1]
+    int *dist[PAIR];  // distances of visited elements from the source [0] and to the target [1]
+    int *queue;       // queue of the search (forward part grows from the start, backward from the end)
+    int *component;   // strongly connected component of each element, labels of reachability are built on first query
+    int components;   // number of components
+    int *memberStart; // members[memberStart[c]..memberStart[c + 1]) are elements of component c
+    int *members;     // elements ordered by component
+    int *pre;         // order in which depth-first search of components enters each component
+    int *post;        // order in which the search leaves it
+    int *low;         // the lowest post of components reachable from it
+    int *mark;        // stamps of components visited by search for reachability
+} graph_t;
 
-typedef struct // relation
+typedef struct // inverted index of sets: lines of sets which contain each element of universe
 {
-    pair_t *pairs;
-    int numberOfPairs;
-} rel_t;
+    int *start;     // postings of element u are bytes[start[u]..start[u + 1])
+    uint8_t *bytes; // line numbers in ascending order, each stored as varint of its gap from the previous one
+} postings_t;
 
-typedef struct // expression
+typedef struct setcal_rel // relation, pairs are stored as two columns of universe indexes
 {
-    char *operation;
-    int argumentsCount;
-    int *arguments;
-} cal_t;
+    uint32_t *left;  // first elements of pairs
+    uint32_t *right; // second elements of pairs
+    int numberOfPairs;
+    int *index;         // hash index of pairs (pair index + 1, 0 is an empty slot), built on first lookup
+    int indexCapacity;  // number of slots in index
+    graph_t *graph;     // adjacency of relation, built on first graph query
+    int *degree[PAIR];  // number of pairs whose first [0] or second [1] element is each element, built on first query
+    int degreeSize;     // elements counted in degree (the largest element of pairs + 1)
+    int loops;          // number of pairs (a a), counted with degree
+    uint64_t digest[2]; // fingerprint of pairs, the same for the same pairs in any order
+    int references;     // number of lines sharing the relation
+} rel_t;
 
 typedef struct // line
 {
     void *ref;
     char type;
-
+    uint64_t fingerprint; // fingerprint of line text
+    postings_t *postings; // universe line: inverted index of sets, built on first lookup of element
 } line_t;
 
-// prototypes
-set_t *Save(char *str, int *errorCode);
-rel_t *SaveRelation(char *str, int *errorCode);
-void ProcessCal(line_t *lines, char *str, int *errorCode);
+typedef struct setcal_model // lines loaded for commands coming later
+{
+    line_t *lines;
+    int numberOfLines;
+} model_t;
 
-// additional functions
-void __complement(set_t *set1, set_t *set2);
-void __minus(set_t *set1, set_t *set2);
-bool __func(rel_t *rel, set_t *universe);
-bool __inject(rel_t *rel, set_t *set1, set_t *set2);
-bool __inSet(rel_t *rel, set_t *set, int numberOfElement);
+static THREAD_LOCAL FILE *output; // stream for results of the calling thread, so queries of more threads don't share it
 
-// set functions
-void SetEmpty(set_t *set);
-void SetCard(set_t *set);
-void SetComplement(set_t *set, set_t *universe);
-void SetUnion(set_t *set1, set_t *set2);
-void SetIntersect(set_t *set1, set_t *set2);
-void SetMinus(set_t *set1, set_t *set2);
-void SetSubseteq(set_t *set1, set_t *set2);
-void SetSubset(set_t *set1, set_t *set2);
-void SetEquals(set_t *set1, set_t *set2);
+typedef struct // line of --output=binary, output collects its text until it's written as one frame
+{
+    FILE *stream; // stream of frames, NULL unless frames are printed
+    char *text;   // text of line
+    size_t size;
+    char type;    // type of frame
+    int *ids;     // elements of set, list or relation frame
+    int count;
+    int capacity;
+} frame_t;
 
-// relation functions
-void RelReflexive(rel_t *rel, set_t *universe);
-void RelSymmetric(rel_t *rel);
-void RelAntisymmetric(rel_t *rel);
-void RelTransitive(rel_t *rel);
-void RelFunction(rel_t *rel, set_t *universe);
-void RelCodomain(rel_t *rel, set_t *universe);
-void RelDomain(rel_t *rel, set_t *universe);
-void RelInjective(rel_t *rel, set_t *set1, set_t *set2);
-void RelBijective(rel_t *rel, set_t *set1, set_t *set2);
-void RelSurjective(rel_t *rel, set_t *set1, set_t *set2);
+static int outputMode; // OUTPUT_TEXT, OUTPUT_IDS or OUTPUT_BINARY
+static frame_t frame;  // line of --output=binary which is being printed
 
-// validators
-int ValidatesStringSet(char *str, void **ref, set_t *universe);
-int ValidatesStringRelation(char *str, void **ref, set_t *universe);
-// start
-int main(int argc, char *argv[])
+// output
+static void PrintTag(char type);
+static void PrintName(set_t *universe, int id);
+static void PrintElement(set_t *universe, int id);
+static void PrintPair(set_t *universe, int left, int right);
+static void PrintUniverse(set_t *universe);
+static void NewLine(void);
+static int FrameOpen(FILE *stream);
+static void FrameEnd(void);
+#ifndef SETCAL_LIBRARY
+static void FrameClose(void);
+#endif
+static void PrintFrame(char type, const uint8_t *payload, int length);
+static void __putVarint(FILE *fp, unsigned value);
+
+static int sketchPrecision; // HyperLogLog has 2^sketchPrecision registers, 0 until sketches are configured
+static int sketchHashes;    // number of MinHash buckets
+static bool sketchOnLoad;   // sketches of sets are built when file is loaded
+static pthread_once_t sketchDefaults = PTHREAD_ONCE_INIT; // sketches of queries of more threads get the same sizes
+
+// returns error message
+static const char *ErrorMessage(int error)
 {
-    // if program was launched with invalid params
-    if (argc != 2)
-        ExitFailure(ARGS_ERR);
+    switch (error)
+    {
+    case MEMORY_ERR:
+        return "Unable to allocate more memory";
+    case ARGS_ERR:
+        return "Invalid Arguments";
+    case FILE_ERR:
+        return "Cannot open file";
+    }
+    return "";
+}
 
-    FILE *fp; // file pointer
+#ifndef SETCAL_LIBRARY
+// error handler
+static void ExitFailure(int error)
+{
+    if (outputMode == OUTPUT_BINARY && frame.stream != NULL)
+    {
+        // error is the last frame, after the unfinished line if something was printed on it
+        fflush(output);
+        if (frame.size || frame.count)
+            FrameEnd();
+        fclose(output);
+        output = frame.stream;
+        PrintFrame(SETCAL_FRAME_ERROR, (const uint8_t *)ErrorMessage(error), strlen(ErrorMessage(error)));
+    }
+    else
+        fprintf(output, "ERROR: ");
+    fprintf(stderr, "%s", ErrorMessage(error));
+    exit(error);
+}
+#endif
 
-    // opens file
-    if ((fp = fopen(argv[1], FILEMODE)) == NULL)
-        ExitFailure(FILE_ERR);
+// structures
 
-    int numberOfLines = 0; // number of lines for array lines
-    int ch;                // char to read file by symbol
-    int sizeOfLine = 0;    // length of each line
+typedef struct // expression
+{
+    char *operation;
+    int argumentsCount;
+    int *arguments;
+    int elementsCount;
+    char *elements[PAIR]; // arguments which are elements of universe
+    unsigned negations;   // bit i is set if argument i is complement of its set (~A)
+    int vector;           // argument which goes over lines of range A..B, -1 if there's none
+    int last;             // last line of range A..B
+    int count;            // number of elements of topk, -1 until it's read
+} cal_t;
 
-    line_t *lines; // lines from the file (pointers to sets and relations)
-    char *line;    // variable to store each line while reading the file
+typedef struct // universe declared by files of batch
+{
+    uint32_t hash; // hash of universe line
+    char *line;    // universe line
+    set_t *set;    // object of universe, shared by all files declaring the same line
+} universe_t;
 
-    if (allocate(lines, sizeof(line_t))) // allocates memory for lines
-        return MEMORY_ERR;
-    if (allocate(line, sizeof(char))) // allocates memory for line
-        return MEMORY_ERR;
+typedef struct // part of work split between threads
+{
+    void *shared; // arguments of the whole work
+    int index;    // number of part
+    int first;    // first item of part
+    int last;     // item after the last one
+} part_t;
 
-    void *errorCheck;  // error pointer
-    int errorCode = 0; // error code
+typedef struct // block of rows of matrix, rows are split between threads
+{
+    set_t **sets;
+    int count;    // number of sets (rows and columns)
+    int words;    // words of bitmaps
+    bool bitmaps; // sets are compared by bitmaps, otherwise by sorted ids
+    bool jaccard; // rows hold sizes of intersections, otherwise subseteq
+    bool dense;
+    int first;    // first row of block
+    int *results; // results of rows of block
+} matrix_t;
 
-    int setBegin = 0;     // index where set or relation starts
-    int commandBegin = 0; // index where command starts
+typedef struct // lines of range A..B computed by more threads
+{
+    line_t *lines;
+    int numberOfLines;
+    cal_t *cal;
+    int first;      // first line of range computed by threads
+    int buckets;    // lines are split by their objects, so lines sharing an object are computed by one thread
+    char **texts;   // results of lines of each bucket
+    size_t *sizes;  // length of texts
+    size_t *starts; // result of each line is texts[bucket][starts[line]..ends[line])
+    size_t *ends;
+    int *errors;    // error code of each line
+} vector_t;
 
-    while ((ch = fgetc(fp)) != EOF)
-    {
-        if (ch == '\n')
-        {
-            line[sizeOfLine] = '\0';
-            sizeOfLine = 0;
+typedef struct // degrees of relation and their histograms counted by more threads, each part counts its own
+{
+    rel_t *rel;
+    int phase;                         // DEGREE_SIZE, DEGREE_COUNT, DEGREE_MERGE, DEGREE_MAX or DEGREE_HISTOGRAM
+    int parts;                         // parts whose counts are merged
+    int size[MAX_THREADS];             // the largest element of pairs of part + 1
+    int *degree[MAX_THREADS][PAIR];    // degrees counted by part, part 0 counts into relation
+    int loops[MAX_THREADS];            // pairs (a a) of part
+    int max[MAX_THREADS][PAIR];        // the largest degree of elements of part
+    int hub[MAX_THREADS][PAIR];        // the first element of part with the largest degree
+    int *histogram[MAX_THREADS][PAIR]; // number of elements of part with each degree
+} degrees_t;
 
-            int length = strlen(line);
+typedef struct // batch of files, processed by more threads at once
+{
+    universe_t *universes;
+    int count;
+    pthread_mutex_t lock; // guards universes and the progress of files
+    char **names;         // names of files
+    int *errors;          // error code of each file, -1 until it's processed
+    int files;            // number of files
+    int next;             // the first file no thread took yet
+    int reported;         // files whose errors were reported (errors are reported in order of files)
+} batch_t;
 
-            if ((length != 1 && line[1] != ' ') || line[length - 1] == ' ') // if string has space at the beginning and at the end
-            {
-                errorCode = ARGS_ERR;
-                break;
-            }
-            if ((!numberOfLines && line[0] != UNIVERSE)) // if the first set is not universum
-            {
-                errorCode = ARGS_ERR;
-                break;
-            }
+typedef struct // result of command remembered between runs
+{
+    uint64_t key; // fingerprint of command and lines it depends on, 0 marks an empty slot
+    char *result; // printed result
+    bool used;    // result belongs to this run
+} entry_t;
 
-            if (line[0] == UNIVERSE ||
-                line[0] == SET)
-            {
-                setBegin = numberOfLines; // assigns index of set
-                lines[numberOfLines].type = SET;
+typedef struct // results of commands (open addressing)
+{
+    entry_t *entries;
+    int capacity;
+    int count;
+} cache_t;
 
-                if ((numberOfLines && line[0] == UNIVERSE)) // if we found the second universum
-                {
-                    errorCode = ARGS_ERR;
-                    break;
-                }
+typedef struct // lines with distinct content (open addressing)
+{
+    int *slots; // line index + 1, 0 is an empty slot
+    int capacity;
+    int count;
+} contents_t;
 
-                // validates and creates new object of set and put its pointer into the lines
-                if ((errorCode = ValidatesStringSet(line, &lines[numberOfLines].ref, (line[0] == UNIVERSE ? NULL : (set_t *)lines[0].ref))))
-                    break;
+typedef struct // commands over the same operands, evaluated together by one sweep
+{
+    int operands[PAIR]; // lines of sets, or line of relation and 0
+    int size;           // number of commands of group
+    int remaining;      // commands of group which weren't printed yet
+    bool swept;         // results were computed
+    int *common[PAIR];  // sets: elements of each set which are in the other one, in its order
+    int *only[PAIR];    // sets: elements of each set which aren't in the other one, in its order
+    int commonCount;
+    int onlyCount[PAIR];
+} group_t;
 
-                /*  prints out set  */
-                if (line[0] == SET)
-                    printf("\n");
+typedef struct // measurements of one phase or operation
+{
+    char name[MAX_LENGTH + 1];
+    long count;                        // number of measured lines
+    uint64_t values[PERF_COUNTERS + 1]; // nanoseconds and counters summed over lines
+} opcode_t;
 
-                putchar(line[0] == UNIVERSE ? UNIVERSE : SET);
+typedef struct // measurements of one line
+{
+    int line;
+    char name[MAX_LENGTH + 1];
+    uint64_t values[PERF_COUNTERS + 1];
+} outlier_t;
 
-                for (int i = 0; i < ((set_t *)(lines[numberOfLines].ref))->numberOfItems; i++)
-                    printf(" %s", ((set_t *)(lines[numberOfLines].ref))->items[i]);
+typedef struct // measurements of --perf mode
+{
+    int fds[PERF_COUNTERS]; // file descriptors of hardware counters, -1 if counter isn't available
+    int line;               // number of lines measured in the current file
+    opcode_t opcodes[PERF_OPCODES];
+    int numberOfOpcodes;
+    outlier_t outliers[PERF_OUTLIERS]; // slowest lines, the slowest first
+    int numberOfOutliers;
+} profile_t;
 
-                numberOfLines++;
-            }
-            else if (line[0] == RELATION)
-            {
-                setBegin = numberOfLines; // assigns index of relation
-                lines[numberOfLines].type = line[0];
+typedef struct job // request of client, executed by a worker thread of server
+{
+    char *request;
+    char *reply;          // lines of result, NULL until request is executed (or if there was no memory for them)
+    bool done;            // reply is ready
+    bool orphaned;        // client disconnected before request was executed, the worker frees it
+    struct job *next;     // next request of the same client
+    struct job *nextWork; // next request waiting for a worker
+} job_t;
 
-                // validates and creates new object of relation and put its pointer into the lines
-                if ((errorCode = ValidatesStringRelation(line, &lines[numberOfLines].ref, (set_t *)lines[0].ref)))
-                    break;
-                /*  prints out relation  */
-                putchar('\n');
-                putchar(RELATION);
-                for (int i = 0; i < ((rel_t *)(lines[numberOfLines].ref))->numberOfPairs; i++)
-                {
-                    printf(" (%s", ((rel_t *)(lines[numberOfLines].ref))->pairs[i].elements[0]);
-                    printf(" %s)", ((rel_t *)(lines[numberOfLines].ref))->pairs[i].elements[1]);
-                }
+typedef struct // client connected to server
+{
+    int fd;
+    char *input;     // received part of request which isn't complete yet
+    int inputSize;
+    char *pending;   // results which weren't sent yet
+    int pendingSize;
+    job_t *jobs;     // requests whose results weren't collected yet, in order they came
+    job_t *lastJob;
+    bool closing;    // client won't send more requests, it's disconnected when results are sent
+} client_t;
 
-                numberOfLines++;
-            }
-            else if (line[0] == CALCULATE)
-            {
-                commandBegin = numberOfLines; // assigns index of command
+typedef struct // server, requests are executed by worker threads over the shared model
+{
+    model_t *model;
+    pthread_mutex_t *locks; // lock of each line, request holds locks of lines it takes as arguments
+    int *owner;             // line whose lock guards object of each line
+    pthread_mutex_t lock;   // guards queue and requests of clients
+    pthread_cond_t ready;   // signalled when request is queued or server stops
+    job_t *queue;           // requests waiting for a worker, in order they came
+    job_t *lastQueued;
+    int wake[2];            // pipe which wakes poll of server when a result is ready or it's asked to stop
+    bool stopping;
+} server_t;
 
-                putchar('\n');
-                ProcessCal(lines, line, &errorCode); // executes commands
-            }
-            else
-            {
-                errorCode = ARGS_ERR;
-            }
+typedef struct // memory budget of --max-memory
+{
+    size_t limit;  // bytes, 0 if there is no budget
+    size_t peak;   // the most bytes in use seen by a check
+    size_t floor;  // bytes in use after the last compaction
+    int compacted; // sets whose items point to names of universe
+    int dropped;   // indexes which were dropped
+    int evicted;   // remembered results which were evicted
+} budget_t;
 
-            // if user declared sets or relations after commands
-            if (commandBegin && commandBegin == setBegin)
-            {
-                errorCode = ARGS_ERR;
-                break;
-            }
-            if (errorCode)
-                break;
+static profile_t *profile; // measurements of lines, NULL unless --perf is given
+static budget_t budget;    // limit of memory and what was done to keep it
+
+// prototypes
+static void FreeLines(line_t *lines, int numberOfLines, bool shared);
+static void FreeSet(set_t *set);
+static void FreeRelation(rel_t *rel);
+static int ProcessFile(FILE *fp, batch_t *batch, model_t *model, cache_t *cache);
+static int SharedUniverse(batch_t *batch, char *str, void **ref);
+static int __addUniverse(batch_t *batch, char *str, uint32_t hash, universe_t **universe);
+static int LoadModel(FILE *fp, model_t *model);
+static char *Execute(model_t *model, char *command, int *errorCode);
+#ifndef SETCAL_LIBRARY
+static int ProfileOpen(void);
+#endif
+static void ProfileStart(uint64_t *sample);
+static void ProfileStop(uint64_t *sample, const char *name, bool line);
+#ifndef SETCAL_LIBRARY
+static void ProfileReport(void);
+static void FreeProfile(void);
+#endif
+static void __opcode(const char *str, char *name);
+static int Govern(line_t *lines, int numberOfLines, cache_t *cache);
+static void MemoryReport(line_t *lines, int numberOfLines);
+static size_t __memoryUsed(line_t *lines, int numberOfLines, cache_t *cache);
+static size_t __footprint(line_t *lines, int line, size_t *indexes);
+static int __compactSets(line_t *lines, int numberOfLines);
+static int __evict(cache_t *cache);
+static int __dropIndexes(line_t *line, bool universe);
+#ifndef SETCAL_LIBRARY
+static int ProcessBatch(char *path);
+static int ProcessBatchFile(char *name, batch_t *batch);
+static void *BatchWorker(void *arg);
+static char *ReadLine(FILE *fp, int *errorCode);
+static size_t __bytes(const char *str);
+static int Serve(char *socketPath, char *path);
+static char *ServeRequest(server_t *server, char *request);
+static int __lockLines(server_t *server, char *request, int **held, int *numberOfHeld);
+static int __owners(server_t *server);
+static void *ServeWorker(void *arg);
+static bool QueueRequest(server_t *server, client_t *client, char *request);
+static bool CollectReplies(server_t *server, client_t *client);
+static void Disconnect(server_t *server, client_t *client);
+static int ProcessIncremental(char *dir, char *path);
+static int Decode(char *path);
+static int LoadCache(cache_t *cache, char *dir);
+static int SaveCache(cache_t *cache, char *dir);
+static bool ServeClient(server_t *server, client_t *client, short events);
+#endif
+static set_t *Save(char *str, int *errorCode);
+static rel_t *SaveRelation(char *str, set_t *universe, int *errorCode);
+static void ProcessCal(line_t *lines, int numberOfLines, char *str, cache_t *cache, int *errorCode);
+static void Calculate(line_t *lines, int numberOfLines, cal_t *cal, int *errorCode);
+static void CalculateRange(line_t *lines, int numberOfLines, cal_t *cal, int first, int *errorCode);
+static int __warm(line_t *lines, int numberOfLines, cal_t *cal);
+static int __bucket(line_t *line, int buckets);
+static void *__rangeLines(void *arg);
+static int ProcessCommands(line_t *lines, int numberOfLines, char **commands, int *numberOfCommands, cache_t *cache);
+static entry_t *CacheFind(cache_t *cache, uint64_t key);
+static int CacheAdd(cache_t *cache, uint64_t key, char *result);
+#ifndef SETCAL_LIBRARY
+static void FreeCache(cache_t *cache);
+#endif
+
+// additional functions
+static int __identify(set_t *set, set_t *universe);
+static int __distinct(uint64_t *keys, int count);
+static void __digest(uint64_t *keys, int count, uint64_t *digest);
+static uint64_t *__digestOf(line_t *line);
+static int __deduplicate(contents_t *contents, line_t *lines, int line);
+static bool __contains(set_t *set, int id);
+static roaring_t *__roaring(set_t *set);
+static void __freeRoaring(roaring_t *roaring);
+static container_t *__container(roaring_t *roaring, int key);
+static bool __containerContains(container_t *container, uint16_t low);
+static void __containerBits(container_t *container, uint64_t *bits);
+static int __containerCommon(container_t *container1, container_t *container2);
+static int __roaringCommon(roaring_t *roaring1, roaring_t *roaring2);
+static bool __roaringSubseteq(roaring_t *roaring1, roaring_t *roaring2);
+static int __roaringComplement(roaring_t *roaring, int size, int *ids);
+static int __complement(set_t *set, set_t *universe, int *ids);
+static int __minus(set_t *set1, set_t *set2, int *ids);
+static int __union(set_t *set1, set_t *set2, int *ids);
+static int __intersect(set_t *set1, set_t *set2, int *ids);
+static bool __subseteq(set_t *set1, set_t *set2);
+static bool __subset(set_t *set1, set_t *set2);
+static bool __equals(set_t *set1, set_t *set2);
+static set_t *__symbolic(int *ids, int count, bool negated, int *errorCode);
+static postings_t *__postings(line_t *lines, int numberOfLines, int *errorCode);
+static void __freePostings(postings_t *postings);
+static int __varintLength(unsigned value);
+static set_t *__negation(set_t *set, bool complement, int *errorCode);
+static set_t *__symbolicIntersect(set_t *set1, bool complement1, set_t *set2, bool complement2, int *errorCode);
+static int __symbolicCard(set_t *set, set_t *universe);
+static bool __reflexive(rel_t *rel, set_t *universe);
+static bool __symmetric(rel_t *rel, set_t *universe, int *errorCode);
+static bool __antisymmetric(rel_t *rel, set_t *universe, int *errorCode);
+static bool __transitive(rel_t *rel, set_t *universe, int *errorCode);
+static bool __func(rel_t *rel, set_t *universe, int *errorCode);
+static int __degrees(rel_t *rel);
+static int __degree(rel_t *rel, int column, int id);
+static void *__degreesPart(void *arg);
+static int __domain(rel_t *rel, set_t *universe, int numberOfElement, int *ids);
+static bool __inject(rel_t *rel, set_t *set1, set_t *set2, int *errorCode);
+static bool __inSet(rel_t *rel, set_t *set, int numberOfElement);
+static bool __injective(rel_t *rel, set_t *set1, set_t *set2, int *errorCode);
+static bool __surjective(rel_t *rel, set_t *set1, set_t *set2, int *errorCode);
+static bool __bijective(rel_t *rel, set_t *set1, set_t *set2, int *errorCode);
+static uint64_t __pairKey(rel_t *rel, int i);
+static bool __containsPair(rel_t *rel, uint64_t key);
+static bool __relSubseteq(rel_t *rel1, rel_t *rel2);
+static bool __relEquals(rel_t *rel1, rel_t *rel2);
+static void PrintPairs(set_t *universe, rel_t *rel1, rel_t *rel2, bool in, bool all);
+static int __labels(graph_t *graph);
+static bool __reaches(graph_t *graph, int from, int to);
+static uint32_t __hash(const char *str);
+static uint64_t __fingerprint(const char *str);
+static uint64_t __mix(uint64_t value);
+static int __indexOf(set_t *set, const char *item);
+static graph_t *__graph(rel_t *rel, set_t *universe, int *errorCode);
+static void __freeGraph(graph_t *graph);
+static int __distance(graph_t *graph, int from, int to);
+static int __find(int *parent, int element);
+static void __unite(int *parent, unsigned char *rank, int a, int b);
+static void __partition(rel_t *rel, set_t *universe, bool equivalence, int *errorCode);
+static int *__scc(graph_t *graph, int *errorCode);
+static int __onCycle(graph_t *graph, int *component, bool loops);
+static void __printCycle(graph_t *graph, set_t *universe, int *component, int start, bool loops);
+static int __intransitive(graph_t *graph, int *middle, int *last);
+static bool __range(char *str, const char *separator, int *first, int *last);
+static int __command(const char *str, char *operation, long *arguments);
+static int __plan(line_t *lines, int numberOfLines, char **commands, int count, int *groupOf, group_t **groups);
+static int __sweep(line_t *lines, group_t *group);
+static void __emit(line_t *lines, group_t *group, char *operation, long *arguments);
+static void __freeGroup(group_t *group);
+static int __threads(void);
+static int __parts(int count, long cost);
+static void __parallel(void *(*work)(void *), void *shared, int count, int parts);
+static int __popcount(uint64_t word);
+static uint64_t *__bits(set_t *set, set_t *universe);
+static int *__sorted(set_t *set);
+static int __compareIds(const void *a, const void *b);
+static int __compareKeys(const void *a, const void *b);
+static int __commonBits(uint64_t *bits1, uint64_t *bits2, int words);
+static bool __subseteqBits(uint64_t *bits1, uint64_t *bits2, int words);
+static int __commonSorted(int *ids1, int count1, int *ids2, int count2);
+static double __jaccard(int common, int count1, int count2);
+static int __common(set_t *set1, set_t *set2, set_t *universe, int *errorCode);
+static int __configureSketch(double error);
+static void __defaultSketch(void);
+static int __leadingZeros(uint64_t word);
+static int __sketch(set_t *set);
+static double __log(double x);
+static double __estimate(uint8_t *registers);
+
+// set functions
+static void PrintElements(set_t *universe, int *ids, int count);
+static void SetEmpty(set_t *set);
+static void SetCard(set_t *set);
+static void SetComplement(set_t *set, set_t *universe, int *errorCode);
+static void SetUnion(set_t *set1, set_t *set2, set_t *universe, int *errorCode);
+static void SetIntersect(set_t *set1, set_t *set2, set_t *universe, int *errorCode);
+static void SetMinus(set_t *set1, set_t *set2, set_t *universe, int *errorCode);
+static void SetSubseteq(set_t *set1, set_t *set2);
+static void SetSubset(set_t *set1, set_t *set2);
+static void SetEquals(set_t *set1, set_t *set2);
+static void SetSymbolic(char *operation, line_t *lines, int *arguments, int count, unsigned negations, int *errorCode);
+static void SetMember(set_t *set, set_t *universe, char *element, int *errorCode);
+static void SetsContaining(line_t *lines, int numberOfLines, char *element, int *errorCode);
+static void SetMatrix(line_t *lines, int numberOfLines, int *arguments, int count, char *operation, char *layout, int *errorCode);
+static void *__matrixRows(void *arg);
+static void SetCardIntersect(set_t *set1, set_t *set2, set_t *universe, int *errorCode);
+static void SetCardUnion(set_t *set1, set_t *set2, set_t *universe, int *errorCode);
+static void SetCardMinus(set_t *set1, set_t *set2, set_t *universe, int *errorCode);
+static void SetJaccard(set_t *set1, set_t *set2, set_t *universe, int *errorCode);
+static void SetApproxCard(set_t *set, int *errorCode);
+static void SetApproxUnionCard(set_t *set1, set_t *set2, int *errorCode);
+static void SetApproxJaccard(set_t *set1, set_t *set2, int *errorCode);
+
+// relation functions
+static void RelReflexive(rel_t *rel, set_t *universe);
+static void RelSymmetric(rel_t *rel, set_t *universe, int *errorCode);
+static void RelAntisymmetric(rel_t *rel, set_t *universe, int *errorCode);
+static void RelTransitive(rel_t *rel, set_t *universe, int *errorCode);
+static void RelFunction(rel_t *rel, set_t *universe, int *errorCode);
+static void RelCodomain(rel_t *rel, set_t *universe, int *errorCode);
+static void RelDomain(rel_t *rel, set_t *universe, int *errorCode);
+static void RelInjective(rel_t *rel, set_t *set1, set_t *set2, int *errorCode);
+static void RelBijective(rel_t *rel, set_t *set1, set_t *set2, int *errorCode);
+static void RelSurjective(rel_t *rel, set_t *set1, set_t *set2, int *errorCode);
+static void RelReach(rel_t *rel, set_t *universe, char *from, char *to, int *errorCode);
+static void RelSucc(rel_t *rel, set_t *universe, char *element, bool predecessors, int *errorCode);
+static void RelStats(rel_t *rel, set_t *universe, int *errorCode);
+static void RelTopK(rel_t *rel, set_t *universe, int count, bool in, int *errorCode);
+static void RelUnion(rel_t *rel1, rel_t *rel2, set_t *universe);
+static void RelIntersect(rel_t *rel1, rel_t *rel2, set_t *universe);
+static void RelMinus(rel_t *rel1, rel_t *rel2, set_t *universe);
+static void RelSubseteq(rel_t *rel1, rel_t *rel2);
+static void RelSubset(rel_t *rel1, rel_t *rel2);
+static void RelEquals(rel_t *rel1, rel_t *rel2);
+static void RelDistance(rel_t *rel, set_t *universe, char *from, char *to, int *errorCode);
+static void RelClasses(rel_t *rel, set_t *universe, int *errorCode);
+static void RelComponents(rel_t *rel, set_t *universe, int *errorCode);
+static void RelPoset(rel_t *rel, set_t *universe, int *errorCode);
+static void RelAcyclic(rel_t *rel, set_t *universe, int *errorCode);
+static void RelToposort(rel_t *rel, set_t *universe, int *errorCode);
+
+// validators
+static int ValidatesStringSet(char *str, void **ref, set_t *universe);
+static int ValidatesStringRelation(char *str, void **ref, set_t *universe);
+#ifndef SETCAL_LIBRARY
+// start
+int main(int argc, char *argv[])
+{
+    output = stdout;
+
+    // options can precede any mode
+    while (argc >= 3)
+    {
+        // builds sketches of all sets at load
+        if (argc >= 4 && !strcmp(argv[1], SKETCH))
+        {
+            char *end;
+            if (__configureSketch(strtod(argv[2], &end)) || *end != '\0')
+                ExitFailure(ARGS_ERR);
+            sketchOnLoad = true;
+            argv[2] = argv[0];
+            argv += 2;
+            argc -= 2;
         }
-        else
+        // prints elements as universe indexes or lines as binary frames
+        else if (!strncmp(argv[1], OUTPUT, strlen(OUTPUT)))
         {
-            line[sizeOfLine++] = ch;
-
-            // resizes line
-            if (reallocate(errorCheck, line, (sizeOfLine + 1) * sizeof(line_t)))
-            {
-                break;
-            }
-            line = errorCheck; // if there wasnt any error, then error check has reference to newly reallocated memory
+            if (!strcmp(argv[1] + strlen(OUTPUT), "ids"))
+                outputMode = OUTPUT_IDS;
+            else if (!strcmp(argv[1] + strlen(OUTPUT), "binary"))
+                outputMode = OUTPUT_BINARY;
+            else
+                ExitFailure(ARGS_ERR);
+            argv[1] = argv[0];
+            argv++;
+            argc--;
         }
-
-        if (numberOfLines >= MAX_LINES)
+        // keeps memory in use under the budget, the report is printed on standard error
+        else if (argc >= 4 && !strcmp(argv[1], MAX_MEMORY))
         {
-            errorCode = ARGS_ERR;
-            break;
+            if (!(budget.limit = __bytes(argv[2])))
+                ExitFailure(ARGS_ERR);
+            argv[2] = argv[0];
+            argv += 2;
+            argc -= 2;
         }
-        // resizes lines
-        if (reallocate(errorCheck, lines, (numberOfLines + 1) * sizeof(line_t)))
+        // measures every line, the report is printed on standard error
+        else if (!strcmp(argv[1], PERF))
         {
-            errorCode = MEMORY_ERR;
-            break;
+            if (ProfileOpen())
+                ExitFailure(MEMORY_ERR);
+            argv[1] = argv[0];
+            argv++;
+            argc--;
         }
-        lines = errorCheck;
+        else
+            break;
     }
 
-    // if user declared 1 line or didn't declare any commands
-    if (numberOfLines < 2 || !commandBegin)
-    {
-        errorCode = ARGS_ERR;
-    }
+    int errorCode = 0;
+    uint64_t sample[PERF_COUNTERS + 1]; // measurement of the whole run
 
-    // memory free
-    free(line);
-    for (int i = 0; i < numberOfLines; i++)
+    // frames are printed only for one file
+    if (outputMode == OUTPUT_BINARY && argc != 2)
+        ExitFailure(ARGS_ERR);
+
+    ProfileStart(sample);
+    // prints frames of --output=binary as text
+    if (argc == 3 && !strcmp(argv[1], DECODE))
+        errorCode = Decode(argv[2]);
+    // processes many files in one run
+    else if (argc == 3 && !strcmp(argv[1], BATCH))
+        errorCode = ProcessBatch(argv[2]);
+    // loads file once and answers commands of clients
+    else if (argc == 4 && !strcmp(argv[1], SERVE))
+        errorCode = Serve(argv[2], argv[3]);
+    // executes only commands whose lines changed since the last run
+    else if (argc == 4 && !strcmp(argv[1], INCREMENTAL))
+        errorCode = ProcessIncremental(argv[2], argv[3]);
+    // if program was launched with invalid params
+    else if (argc != 2)
+        ExitFailure(ARGS_ERR);
+    else
     {
-        if (lines[i].type == SET)
-        {
-            for (int j = 0; j < ((set_t *)lines[i].ref)->numberOfItems; j++)
-            {
-                free(((set_t *)lines[i].ref)->items[j]);
-            }
-            free(((set_t *)lines[i].ref)->items);
-        }
-        if (lines[i].type == RELATION)
-        {
+        FILE *fp; // file pointer
 
-            free(((rel_t *)lines[i].ref)->pairs);
-        }
+        // opens file
+        if ((fp = fopen(argv[1], FILEMODE)) == NULL)
+            ExitFailure(FILE_ERR);
+
+        if (outputMode == OUTPUT_BINARY && FrameOpen(stdout))
+            ExitFailure(MEMORY_ERR);
+        errorCode = ProcessFile(fp, NULL, NULL, NULL);
+        fclose(fp); // close file
+        if (!errorCode)
+            FrameClose();
     }
-    for (int i = 0; i < numberOfLines; i++)
-        free(lines[i].ref); // frees each pointer to array (string) in lines
-    free(lines);            // frees pointer of poiters
-    fclose(fp);             // close file
+    ProfileStop(sample, "total", false);
+    ProfileReport();
+    FreeProfile();
 
-    if (errorCode)
+    if (errorCode && argc == 2)
         ExitFailure(errorCode);
     return errorCode;
 }
 
-// converts string into set
-set_t *Save(char *str, int *errorCode)
+// returns bytes of size "N", "NK", "NM" or "NG", 0 if it isn't valid
+static size_t __bytes(const char *str)
 {
-    set_t *set; // variable to store new set
-    char *pch;  // variable to keep results of strtok
+    char *end;
+    unsigned long long size;
 
-    if (allocate(set, sizeof(set_t))) // allocates memory for set
+    if (str[0] < '0' || str[0] > '9')
+        return 0;
+    size = strtoull(str, &end, 10);
+    if (*end && end[1])
+        return 0;
+    switch (*end)
     {
-        *errorCode = MEMORY_ERR;
-        return NULL;
+    case 'G':
+        size <<= 10;
+        /* fall through */
+    case 'M':
+        size <<= 10;
+        /* fall through */
+    case 'K':
+        size <<= 10;
+        /* fall through */
+    case '\0':
+        return size;
     }
-    set->numberOfItems = 0;                   // resets count of the elements
-    if (allocate(set->items, sizeof(char *))) // allocates memory for set items
+    return 0;
+}
+
+// reads one line of file without line break, returns NULL at the end of file or if there is no memory
+static char *ReadLine(FILE *fp, int *errorCode)
+{
+    char *line;  // read line
+    void *error; // error pointer
+    int ch;      // char to read file by symbol
+    int size = 0;
+
+    if ((ch = fgetc(fp)) == EOF)
+        return NULL;
+    if (allocate(line, sizeof(char)))
     {
-        free(set);
         *errorCode = MEMORY_ERR;
         return NULL;
     }
-    void *error; // error pointer
-
-    pch = strtok(str, SPACE);
 
-    while ((pch = strtok(NULL, SPACE)) != NULL)
+    for (; ch != EOF && ch != '\n'; ch = fgetc(fp))
     {
-        if (strlen(pch) > MAX_LENGTH) // if length of pch is greater than 30
-        {
-            *errorCode = ARGS_ERR;
-            break;
-        }
-        for (int i = 0; i < RESTRICTED_COUNT; i++) // if element is one of restricted words
-        {
-            if (!strcmp(pch, RESTRICTED[i]))
-            {
-                *errorCode = ARGS_ERR;
-                break;
-            }
-        }
-        if (allocate(set->items[set->numberOfItems], strlen(pch) + 1)) // allocates memory for one element
+        if (ch == '\r')
+            continue;
+        line[size++] = ch;
+        if (reallocate(error, line, (size + 1) * sizeof(char)))
         {
+            free(line);
             *errorCode = MEMORY_ERR;
-            break;
+            return NULL;
         }
-        strcpy(set->items[set->numberOfItems], pch); // copies element into the object
-        set->numberOfItems++;
+        line = error;
+    }
+    line[size] = '\0';
+    return line;
+}
 
-        // resizes items of set
-        if (reallocate(error, set->items, (set->numberOfItems + 1) * sizeof(char *)))
-        {
-            *errorCode = MEMORY_ERR;
+// processes one file of batch, its results are written next to it
+static int ProcessBatchFile(char *name, batch_t *batch)
+{
+    FILE *fp = NULL;   // input file
+    FILE *file = NULL; // output file
+    char *result;      // name of output file
+    int errorCode = 0;
+
+    if (allocate(result, strlen(name) + strlen(OUTPUT_SUFFIX) + 1))
+        return MEMORY_ERR;
+    strcpy(result, name);
+    strcat(result, OUTPUT_SUFFIX);
+
+    if ((fp = fopen(name, FILEMODE)) == NULL || (file = fopen(result, "w")) == NULL)
+        errorCode = FILE_ERR;
+    else
+    {
+        output = file;
+        if ((errorCode = ProcessFile(fp, batch, NULL, NULL)))
+            fprintf(output, "ERROR: ");
+        output = stdout;
+        fclose(file);
+    }
+
+    if (fp != NULL)
+        fclose(fp);
+    free(result);
+    return errorCode;
+}
+
+// processes files of batch until none is left, errors are reported on standard error in order of files
+static void *BatchWorker(void *arg)
+{
+    batch_t *batch = arg;
+    int file;
+
+    output = stdout; // output is set for each thread
+    while (true)
+    {
+        pthread_mutex_lock(&batch->lock);
+        file = batch->next < batch->files ? batch->next++ : -1;
+        pthread_mutex_unlock(&batch->lock);
+        if (file < 0)
+            break;
+
+        int errorCode = ProcessBatchFile(batch->names[file], batch);
+
+        pthread_mutex_lock(&batch->lock);
+        batch->errors[file] = errorCode;
+        for (; batch->reported < batch->files && batch->errors[batch->reported] >= 0; batch->reported++)
+            if (batch->errors[batch->reported])
+                fprintf(stderr, "%s: %s\n", batch->names[batch->reported], ErrorMessage(batch->errors[batch->reported]));
+        pthread_mutex_unlock(&batch->lock);
+    }
+    return NULL;
+}
+
+// processes every file named in list (one on each line) or every file of directory, files are split between threads
+static int ProcessBatch(char *path)
+{
+    batch_t batch = {.universes = NULL, .count = 0, .names = NULL, .errors = NULL, .files = 0, .next = 0, .reported = 0};
+    DIR *dir;           // directory of files
+    FILE *list = NULL;  // list of files
+    char *name;         // name of file
+    void *error;        // error pointer
+    int errorCode = 0;  // error code of the first failed file
+    pthread_t threads[MAX_THREADS];
+    int numberOfThreads;
+
+    if ((dir = opendir(path)) == NULL && (list = fopen(path, FILEMODE)) == NULL)
+        ExitFailure(FILE_ERR);
+
+    // names are read before files are processed, so threads can take them in order
+    while (true)
+    {
+        if (dir != NULL)
+        {
+            struct dirent *entry;
+            struct stat info;
+
+            if ((entry = readdir(dir)) == NULL)
+                break;
+            // skips hidden files and results of previous runs
+            if (entry->d_name[0] == '.' || (strlen(entry->d_name) >= strlen(OUTPUT_SUFFIX) &&
+                                             !strcmp(entry->d_name + strlen(entry->d_name) - strlen(OUTPUT_SUFFIX), OUTPUT_SUFFIX)))
+                continue;
+            if (allocate(name, strlen(path) + strlen(entry->d_name) + 2))
+                ExitFailure(MEMORY_ERR);
+            sprintf(name, "%s/%s", path, entry->d_name);
+            if (stat(name, &info) || !S_ISREG(info.st_mode))
+            {
+                free(name);
+                continue;
+            }
+        }
+        else if ((name = ReadLine(list, &errorCode)) == NULL)
+        {
+            if (errorCode)
+                ExitFailure(errorCode);
+            break;
+        }
+        else if (!name[0]) // skips empty lines
+        {
+            free(name);
+            continue;
+        }
+
+        if (reallocate(error, batch.names, (batch.files + 1) * sizeof(char *)))
+            ExitFailure(MEMORY_ERR);
+        batch.names = error;
+        batch.names[batch.files++] = name;
+    }
+    if (dir != NULL)
+        closedir(dir);
+    if (list != NULL)
+        fclose(list);
+
+    if (allocate(batch.errors, (batch.files + 1) * sizeof(int)))
+        ExitFailure(MEMORY_ERR);
+    for (int i = 0; i < batch.files; i++)
+        batch.errors[i] = -1;
+    pthread_mutex_init(&batch.lock, NULL);
+
+    // measurements and the memory budget belong to the whole process, so files are then processed one at a time
+    numberOfThreads = profile != NULL || budget.limit ? 1 : __threads();
+    if (numberOfThreads > batch.files)
+        numberOfThreads = batch.files;
+    // the calling thread is one of threads, the others which can't be started are left out
+    for (int i = 1; i < numberOfThreads; i++)
+        if (pthread_create(&threads[i], NULL, BatchWorker, &batch))
+            numberOfThreads = i;
+    BatchWorker(&batch);
+    for (int i = 1; i < numberOfThreads; i++)
+        pthread_join(threads[i], NULL);
+
+    for (int i = 0; i < batch.files && !errorCode; i++)
+        errorCode = batch.errors[i];
+
+    // memory free
+    for (int i = 0; i < batch.count; i++)
+    {
+        FreeSet(batch.universes[i].set);
+        free(batch.universes[i].line);
+    }
+    for (int i = 0; i < batch.files; i++)
+        free(batch.names[i]);
+    free(batch.universes);
+    free(batch.names);
+    free(batch.errors);
+    pthread_mutex_destroy(&batch.lock);
+
+    return errorCode;
+}
+
+// reads results remembered in directory by previous run
+static int LoadCache(cache_t *cache, char *dir)
+{
+    FILE *fp;
+    char *name; // name of cache file
+    char *line; // line of cache file ("key result", result has newlines and backslashes escaped)
+    int errorCode = 0;
+
+    if (mkdir(dir, 0777) && errno != EEXIST)
+        return FILE_ERR;
+    if (allocate(name, strlen(dir) + strlen(CACHE_FILE) + 1))
+        return MEMORY_ERR;
+    sprintf(name, "%s%s", dir, CACHE_FILE);
+
+    if ((fp = fopen(name, FILEMODE)) != NULL) // there is no cache before the first run
+    {
+        char *header = ReadLine(fp, &errorCode);
+
+        // results of older formats may be cut at their first newline, they are computed again
+        while (header != NULL && !strcmp(header, CACHE_HEADER) && !errorCode && (line = ReadLine(fp, &errorCode)) != NULL)
+        {
+            char *result;
+            uint64_t key = strtoull(line, &result, 16);
+            char *copy;
+
+            if (key && *result == ' ' && CacheFind(cache, key) == NULL)
+            {
+                if (allocate(copy, strlen(result)))
+                    errorCode = MEMORY_ERR;
+                else
+                {
+                    int size = 0;
+                    for (char *c = result + 1; *c; c++)
+                        copy[size++] = *c == '\\' && c[1] ? (*++c == 'n' ? '\n' : *c) : *c;
+                    copy[size] = '\0';
+                    if ((errorCode = CacheAdd(cache, key, copy)))
+                        free(copy);
+                    else
+                        CacheFind(cache, key)->used = false;
+                }
+            }
+            free(line);
+        }
+        free(header);
+        fclose(fp);
+    }
+    free(name);
+    return errorCode;
+}
+
+// writes results used by this run into directory, so the next run can use them
+static int SaveCache(cache_t *cache, char *dir)
+{
+    FILE *fp;
+    char *name; // name of cache file
+    char *temp; // cache is written to temporary file first, so it's never left half written
+    int errorCode = 0;
+
+    if (allocate(name, strlen(dir) + strlen(CACHE_FILE) + 1))
+        return MEMORY_ERR;
+    if (allocate(temp, strlen(dir) + strlen(CACHE_TEMP) + 1))
+    {
+        free(name);
+        return MEMORY_ERR;
+    }
+    sprintf(name, "%s%s", dir, CACHE_FILE);
+    sprintf(temp, "%s%s", dir, CACHE_TEMP);
+
+    if ((fp = fopen(temp, "w")) == NULL)
+        errorCode = FILE_ERR;
+    else
+    {
+        fprintf(fp, "%s\n", CACHE_HEADER);
+        for (int i = 0; i < cache->capacity; i++)
+            if (cache->entries[i].key && cache->entries[i].used)
+            {
+                // results of ranges have more lines, every entry is kept on one line of cache file
+                fprintf(fp, "%016llx ", (unsigned long long)cache->entries[i].key);
+                for (char *c = cache->entries[i].result; *c; c++)
+                {
+                    if (*c == '\n' || *c == '\\')
+                        fputc('\\', fp);
+                    fputc(*c == '\n' ? 'n' : *c, fp);
+                }
+                fputc('\n', fp);
+            }
+        if (fclose(fp) || rename(temp, name))
+            errorCode = FILE_ERR;
+    }
+    free(name);
+    free(temp);
+    return errorCode;
+}
+
+// processes file, results of commands whose lines didn't change are taken from the previous run
+static int ProcessIncremental(char *dir, char *path)
+{
+    cache_t cache = {NULL, 0, 0};
+    FILE *fp;
+    int errorCode;
+
+    if ((fp = fopen(path, FILEMODE)) == NULL)
+        ExitFailure(FILE_ERR);
+
+    if (!(errorCode = LoadCache(&cache, dir)))
+    {
+        errorCode = ProcessFile(fp, NULL, NULL, &cache);
+        if (!errorCode)
+            errorCode = SaveCache(&cache, dir);
+    }
+    FreeCache(&cache);
+    fclose(fp);
+
+    if (errorCode)
+        ExitFailure(errorCode);
+    return errorCode;
+}
+
+static volatile sig_atomic_t stopped = 0; // set when server is asked to stop
+static int wakeFd = -1;                   // pipe which wakes poll of server, so a signal before poll isn't missed
+
+// prints frames of file (- is standard input) as text, elements of every frame by their names
+static int Decode(char *path)
+{
+    FILE *fp = strcmp(path, "-") ? fopen(path, "rb") : stdin;
+    char **names = NULL; // names of elements from universe frame
+    int numberOfNames = 0;
+    uint8_t *data = NULL;
+    int *ids = NULL;
+    int length, count, result;
+    char type;
+    bool first = true;
+    void *error; // error pointer
+    int errorCode = 0;
+
+    if (fp == NULL)
+        return FILE_ERR;
+    while (!errorCode && (result = SetcalReadFrame(fp, &type, &data, &length)) == 1)
+    {
+        if (!first)
+            fputc('\n', output);
+        first = false;
+
+        if (type == SETCAL_FRAME_UNIVERSE)
+        {
+            fputc(UNIVERSE, output);
+            for (int k = 0; k < length && !errorCode;)
+            {
+                unsigned size = 0;
+                for (int shift = 0; k < length; shift += 7)
+                {
+                    size |= (unsigned)(data[k] & 0x7f) << shift;
+                    if (!(data[k++] & 0x80))
+                        break;
+                }
+                if (size > (unsigned)(length - k) || reallocate(error, names, (numberOfNames + 1) * sizeof(char *)) ||
+                    (((char **)error)[numberOfNames] = malloc(size + 1)) == NULL)
+                {
+                    errorCode = size > (unsigned)(length - k) ? FILE_ERR : MEMORY_ERR;
+                    break;
+                }
+                names = error;
+                memcpy(names[numberOfNames], data + k, size);
+                names[numberOfNames][size] = '\0';
+                fprintf(output, " %s", names[numberOfNames++]);
+                k += size;
+            }
+        }
+        else if (type == SETCAL_FRAME_SET || type == SETCAL_FRAME_LIST || type == SETCAL_FRAME_RELATION)
+        {
+            if (reallocate(error, ids, (8 * length + 1) * sizeof(int)))
+            {
+                errorCode = MEMORY_ERR;
+                break;
+            }
+            ids = error;
+            if ((count = SetcalFrameIds(type, data, length, ids)) < 0)
+            {
+                errorCode = FILE_ERR;
+                break;
+            }
+            fputc(type == SETCAL_FRAME_RELATION ? RELATION : SET, output);
+            for (int i = 0; i < count; i++)
+            {
+                if (ids[i] >= numberOfNames)
+                {
+                    errorCode = FILE_ERR;
+                    break;
+                }
+                if (type == SETCAL_FRAME_RELATION)
+                    fprintf(output, i % 2 ? " %s)" : " (%s", names[ids[i]]);
+                else
+                    fprintf(output, " %s", names[ids[i]]);
+            }
+        }
+        else if (type == SETCAL_FRAME_ERROR)
+            fprintf(output, "ERROR: %.*s", length, (char *)data);
+        else
+            for (int k = 0; k < length; k++)
+            {
+                long id = 0;
+
+                if (data[k] != '#' || k + 1 == length || data[k + 1] < '0' || data[k + 1] > '9')
+                {
+                    fputc(data[k], output);
+                    continue;
+                }
+                // index of element in text (#id) is replaced by its name
+                while (k + 1 < length && data[k + 1] >= '0' && data[k + 1] <= '9' && id < numberOfNames)
+                    id = 10 * id + data[++k] - '0';
+                if (id >= numberOfNames)
+                {
+                    errorCode = FILE_ERR;
+                    break;
+                }
+                fputs(names[id], output);
+            }
+    }
+    if (!errorCode && result < 0)
+        errorCode = FILE_ERR;
+
+    if (fp != stdin)
+        fclose(fp);
+    for (int i = 0; i < numberOfNames; i++)
+        free(names[i]);
+    free(names);
+    free(data);
+    free(ids);
+    return errorCode;
+}
+
+// stops server
+static void Stop(int signal)
+{
+    int saved = errno; // errno of the interrupted code
+
+    (void)signal;
+    stopped = 1;
+    if (wakeFd >= 0)
+    {
+        ssize_t written = write(wakeFd, "", 1); // a full pipe wakes the server as well
+        (void)written;
+    }
+    errno = saved;
+}
+
+// returns lines of result of request ("[id] C ..."), each as "[id] result", NULL without memory
+static char *ServeRequest(server_t *server, char *request)
+{
+    model_t *model = server->model;
+    char *id = NULL;     // id of request
+    char *result = NULL; // result of command
+    char *reply;         // lines which are sent
+    int *held = NULL;    // lines whose locks are held
+    int numberOfHeld = 0;
+    int errorCode = 0;
+
+    // request starts with its id
+    if (request[0] != CALCULATE && (id = request, request = strchr(request, ' ')) != NULL)
+        *request++ = '\0';
+
+    if (request == NULL || request[0] != CALCULATE || (request[1] != ' ' && request[1] != '\0'))
+        errorCode = ARGS_ERR;
+    else if (!(errorCode = __lockLines(server, request, &held, &numberOfHeld)) &&
+             !(errorCode = Govern(model->lines, model->numberOfLines, NULL)))
+        result = Execute(model, request, &errorCode);
+    for (int i = numberOfHeld - 1; i >= 0; i--)
+        pthread_mutex_unlock(&server->locks[held[i]]);
+    free(held);
+
+    const char *text = errorCode ? ErrorMessage(errorCode) : result;
+    int lines = 1; // command over range A..B has more lines of result, each of them starts with id
+    for (const char *ch = text; *ch; ch++)
+        lines += *ch == '\n';
+    int length = lines * (id != NULL ? strlen(id) + 1 : 0) + (errorCode ? strlen("ERROR: ") : 0) + strlen(text) + 1;
+    int size = 0;
+
+    if (allocate(reply, length + 1))
+    {
+        free(result);
+        return NULL;
+    }
+    for (const char *line = text, *end; line != NULL; line = *end ? end + 1 : NULL)
+    {
+        end = strchr(line, '\n');
+        if (end == NULL)
+            end = line + strlen(line);
+        size += sprintf(reply + size, "%s%s%s%.*s\n", id != NULL ? id : "", id != NULL ? " " : "",
+                        errorCode ? "ERROR: " : "", (int)(end - line), line);
+    }
+    free(result);
+    return reply;
+}
+
+/*
+ * Locks the lines which command takes as arguments (A, ~A, A-B, A..B, every
+ * line for sets-containing, but not the count of topk), lines sharing one
+ * object are guarded by the lock of the first of them. Locks are taken in ascending order, so requests of more
+ * workers can't wait for each other in a cycle.
+ */
+static int __lockLines(server_t *server, char *request, int **held, int *numberOfHeld)
+{
+    int numberOfLines = server->model->numberOfLines;
+    char *copy;  // request is split by strtok_r
+    char *pch;   // word of request
+    char *rest;  // position of strtok_r in copy
+    void *error; // error pointer
+    int first;
+    int last;
+    int argument = 0; // the second argument of topk is a count
+    bool topk;
+
+    if (allocate(copy, strlen(request) + 1))
+        return MEMORY_ERR;
+    strcpy(copy, request);
+
+    pch = strtok_r(copy, SPACE, &rest);
+    pch = strtok_r(NULL, SPACE, &rest);
+    topk = pch != NULL && (!strcmp(pch, TOPK_OUT) || !strcmp(pch, TOPK_IN));
+    if (pch != NULL && !strcmp(pch, SETS_CONTAINING))
+    {
+        first = 1;
+        last = numberOfLines;
+    }
+    else
+        first = last = 0;
+
+    while (true)
+    {
+        if (first < 1)
+            first = 1;
+        if (last > numberOfLines)
+            last = numberOfLines;
+        for (int line = first; line <= last; line++)
+        {
+            if (reallocate(error, *held, (*numberOfHeld + 1) * sizeof(int)))
+            {
+                free(copy);
+                *numberOfHeld = 0;
+                return MEMORY_ERR;
+            }
+            *held = error;
+            (*held)[(*numberOfHeld)++] = server->owner[line - 1];
+        }
+
+        if (pch == NULL || (pch = strtok_r(NULL, SPACE, &rest)) == NULL)
+            break;
+        if (topk && ++argument == 2)
+            first = last = 0;
+        else if (!__range(pch, VECTOR, &first, &last) && !__range(pch, SPAN, &first, &last))
+            first = last = atoi(pch[0] == NEGATION ? pch + 1 : pch);
+    }
+    free(copy);
+    if (!*numberOfHeld) // command without lines
+        return EXIT_SUCCESS;
+
+    // lines are sorted, each of them is locked once
+    qsort(*held, *numberOfHeld, sizeof(int), __compareIds);
+    int count = 0;
+    for (int i = 0; i < *numberOfHeld; i++)
+        if (!count || (*held)[i] != (*held)[count - 1])
+            (*held)[count++] = (*held)[i];
+    *numberOfHeld = count;
+    for (int i = 0; i < count; i++)
+        pthread_mutex_lock(&server->locks[(*held)[i]]);
+    return EXIT_SUCCESS;
+}
+
+// executes queued requests until server stops, the server is woken up when a result is ready
+static void *ServeWorker(void *arg)
+{
+    server_t *server = arg;
+    job_t *job;
+
+    output = stdout; // output is set for each thread
+    pthread_mutex_lock(&server->lock);
+    while (true)
+    {
+        while (server->queue == NULL && !server->stopping)
+            pthread_cond_wait(&server->ready, &server->lock);
+        if (server->stopping)
+            break;
+        job = server->queue;
+        if ((server->queue = job->nextWork) == NULL)
+            server->lastQueued = NULL;
+        pthread_mutex_unlock(&server->lock);
+
+        char *reply = ServeRequest(server, job->request);
+
+        pthread_mutex_lock(&server->lock);
+        if (job->orphaned) // client disconnected meanwhile
+        {
+            free(reply);
+            free(job->request);
+            free(job);
+            continue;
+        }
+        job->reply = reply;
+        job->done = true;
+        ssize_t written = write(server->wake[1], "", 1); // a full pipe wakes the server as well
+        (void)written;
+    }
+    pthread_mutex_unlock(&server->lock);
+    return NULL;
+}
+
+// queues request of client for workers, its result is sent in order of requests of client
+static bool QueueRequest(server_t *server, client_t *client, char *request)
+{
+    job_t *job;
+
+    if (allocate(job, sizeof(job_t)))
+        return false;
+    if (allocate(job->request, strlen(request) + 1))
+    {
+        free(job);
+        return false;
+    }
+    strcpy(job->request, request);
+    job->reply = NULL;
+    job->done = false;
+    job->orphaned = false;
+    job->next = NULL;
+    job->nextWork = NULL;
+
+    pthread_mutex_lock(&server->lock);
+    if (server->lastQueued != NULL)
+        server->lastQueued->nextWork = job;
+    else
+        server->queue = job;
+    server->lastQueued = job;
+    pthread_cond_signal(&server->ready);
+    pthread_mutex_unlock(&server->lock);
+
+    if (client->lastJob != NULL)
+        client->lastJob->next = job;
+    else
+        client->jobs = job;
+    client->lastJob = job;
+    return true;
+}
+
+// moves results of finished requests of client, which are the first of its requests, to results waiting for sending
+static bool CollectReplies(server_t *server, client_t *client)
+{
+    void *error; // error pointer
+    bool collected = true;
+
+    pthread_mutex_lock(&server->lock);
+    while (client->jobs != NULL && client->jobs->done)
+    {
+        job_t *job = client->jobs;
+        int length = job->reply != NULL ? strlen(job->reply) : 0; // result without memory is left out
+
+        if (length && reallocate(error, client->pending, client->pendingSize + length + 1))
+        {
+            collected = false;
             break;
         }
-        set->items = error;
+        if (length)
+        {
+            client->pending = error;
+            memcpy(client->pending + client->pendingSize, job->reply, length + 1);
+            client->pendingSize += length;
+        }
+        if ((client->jobs = job->next) == NULL)
+            client->lastJob = NULL;
+        free(job->reply);
+        free(job->request);
+        free(job);
+    }
+    pthread_mutex_unlock(&server->lock);
+    return collected;
+}
+
+// closes connection of client, its requests which workers didn't finish are freed by them
+static void Disconnect(server_t *server, client_t *client)
+{
+    close(client->fd);
+    free(client->input);
+    free(client->pending);
+    pthread_mutex_lock(&server->lock);
+    for (job_t *job = client->jobs, *next; job != NULL; job = next)
+    {
+        next = job->next;
+        if (job->done)
+        {
+            free(job->reply);
+            free(job->request);
+            free(job);
+        }
+        else
+            job->orphaned = true;
+    }
+    pthread_mutex_unlock(&server->lock);
+}
+
+// reads requests of client and sends results, returns false when client should be disconnected
+static bool ServeClient(server_t *server, client_t *client, short events)
+{
+    void *error; // error pointer
+
+    if (events & POLLIN)
+    {
+        char buffer[BUFFER_SIZE];
+        ssize_t received = recv(client->fd, buffer, BUFFER_SIZE, 0);
+
+        if (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            return false;
+        if (received == 0)
+        {
+            // executes the last request even if it isn't ended by line break
+            client->closing = true;
+            if (client->inputSize)
+            {
+                client->input[client->inputSize] = '\0';
+                if (!QueueRequest(server, client, client->input))
+                    return false;
+                client->inputSize = 0;
+            }
+        }
+        else if (received > 0)
+        {
+            if (reallocate(error, client->input, client->inputSize + received + 1))
+                return false;
+            client->input = error;
+            memcpy(client->input + client->inputSize, buffer, received);
+            client->inputSize += received;
+
+            // queues every complete request in order they came
+            char *begin = client->input;
+            char *end;
+            while ((end = memchr(begin, '\n', client->input + client->inputSize - begin)) != NULL)
+            {
+                *end = '\0';
+                if (end > begin && end[-1] == '\r')
+                    end[-1] = '\0';
+                if (*begin && !QueueRequest(server, client, begin))
+                    return false;
+                begin = end + 1;
+            }
+            client->inputSize -= begin - client->input;
+            memmove(client->input, begin, client->inputSize);
+        }
+    }
+    else if (events & (POLLERR | POLLNVAL) || ((events & POLLHUP) && !client->pendingSize))
+        return false;
+
+    if (!CollectReplies(server, client))
+        return false;
+    if (client->pendingSize)
+    {
+        ssize_t sent = send(client->fd, client->pending, client->pendingSize, MSG_NOSIGNAL);
+
+        if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            return false;
+        if (sent > 0)
+        {
+            client->pendingSize -= sent;
+            memmove(client->pending, client->pending + sent, client->pendingSize);
+        }
+    }
+    return !client->closing || client->pendingSize || client->jobs != NULL;
+}
+
+// assigns each line the line whose lock guards its object, lines with the same content share object and its lock
+static int __owners(server_t *server)
+{
+    model_t *model = server->model;
+    uint64_t *keys; // address of object and line
+
+    if (allocate(server->owner, (model->numberOfLines + 1) * sizeof(int)) ||
+        allocate(keys, (model->numberOfLines + 1) * sizeof(uint64_t) * 2))
+        return MEMORY_ERR;
+    for (int i = 0; i < model->numberOfLines; i++)
+    {
+        keys[2 * i] = (uint64_t)(uintptr_t)model->lines[i].ref;
+        keys[2 * i + 1] = i;
+    }
+    qsort(keys, model->numberOfLines, 2 * sizeof(uint64_t), __compareKeys);
+    for (int i = 0; i < model->numberOfLines; i++)
+        server->owner[keys[2 * i + 1]] = i && keys[2 * i] == keys[2 * i - 2] ? server->owner[keys[2 * i - 1]] : (int)keys[2 * i + 1];
+    free(keys);
+    return EXIT_SUCCESS;
+}
+
+// loads file and answers requests of clients connected to unix socket until it's interrupted, requests are executed by worker threads
+static int Serve(char *socketPath, char *path)
+{
+    model_t model;             // loaded lines
+    server_t server;           // queue of requests and locks of lines
+    client_t *clients = NULL;  // connected clients
+    struct pollfd *fds = NULL; // socket of server, pipe of workers and sockets of clients
+    int count = 0;             // number of clients
+    pthread_t workers[MAX_THREADS];
+    int numberOfWorkers;
+    struct sockaddr_un address;
+    struct sigaction action;
+    sigset_t signals;
+    int listener;
+    FILE *fp;
+    int errorCode;
+    void *error; // error pointer
+
+    if (strlen(socketPath) >= sizeof(address.sun_path))
+        ExitFailure(ARGS_ERR);
+    if ((fp = fopen(path, FILEMODE)) == NULL)
+        ExitFailure(FILE_ERR);
+
+    errorCode = LoadModel(fp, &model);
+    fclose(fp);
+    if (errorCode)
+        ExitFailure(errorCode);
+
+    // lines are shared by workers, hash index of universe is built before they look up elements in it
+    memset(&server, 0, sizeof(server));
+    server.model = &model;
+    __indexOf((set_t *)model.lines[0].ref, "");
+    if (((set_t *)model.lines[0].ref)->index == NULL || __owners(&server) ||
+        allocate(server.locks, model.numberOfLines * sizeof(pthread_mutex_t)))
+    {
+        free(server.owner);
+        FreeLines(model.lines, model.numberOfLines, false);
+        ExitFailure(MEMORY_ERR);
+    }
+    for (int i = 0; i < model.numberOfLines; i++)
+        pthread_mutex_init(&server.locks[i], NULL);
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socketPath);
+    unlink(socketPath);
+    if ((listener = socket(AF_UNIX, SOCK_STREAM, 0)) < 0 || bind(listener, (struct sockaddr *)&address, sizeof(address)) ||
+        listen(listener, SOMAXCONN) || fcntl(listener, F_SETFL, O_NONBLOCK) || pipe(server.wake) ||
+        fcntl(server.wake[0], F_SETFL, O_NONBLOCK) || fcntl(server.wake[1], F_SETFL, O_NONBLOCK))
+    {
+        FreeLines(model.lines, model.numberOfLines, false);
+        ExitFailure(FILE_ERR);
+    }
+
+    // signal ends the loop, it writes to the pipe in case it comes before poll
+    wakeFd = server.wake[1];
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = Stop;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    // workers don't take signals, so they interrupt poll of this thread; measurements and the memory budget belong to the
+    // whole process, so requests are then executed by one worker
+    pthread_mutex_init(&server.lock, NULL);
+    pthread_cond_init(&server.ready, NULL);
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+    numberOfWorkers = profile != NULL || budget.limit ? 1 : __threads();
+    for (int i = 0; i < numberOfWorkers; i++)
+        if (pthread_create(&workers[i], NULL, ServeWorker, &server))
+            numberOfWorkers = i;
+    pthread_sigmask(SIG_UNBLOCK, &signals, NULL);
+    if (!numberOfWorkers)
+        errorCode = MEMORY_ERR;
+
+    while (!stopped && !errorCode)
+    {
+        if (reallocate(error, fds, (count + 2) * sizeof(struct pollfd)))
+        {
+            errorCode = MEMORY_ERR;
+            break;
+        }
+        fds = error;
+        fds[0].fd = listener;
+        fds[0].events = POLLIN;
+        fds[1].fd = server.wake[0];
+        fds[1].events = POLLIN;
+        for (int i = 0; i < count; i++)
+        {
+            fds[i + 2].fd = clients[i].fd;
+            fds[i + 2].events = (clients[i].closing ? 0 : POLLIN) | (clients[i].pendingSize ? POLLOUT : 0);
+        }
+
+        if (poll(fds, count + 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            errorCode = FILE_ERR;
+            break;
+        }
+
+        // results of workers are collected for every client
+        char drain[BUFFER_SIZE];
+        bool woken = fds[1].revents & POLLIN;
+        while (woken && read(server.wake[0], drain, BUFFER_SIZE) > 0)
+            ;
+
+        // serves clients, disconnected ones are removed
+        int polled = count;
+        for (int i = polled - 1; i >= 0; i--)
+            if ((fds[i + 2].revents || woken) && !ServeClient(&server, &clients[i], fds[i + 2].revents))
+            {
+                Disconnect(&server, &clients[i]);
+                clients[i] = clients[--count];
+            }
+
+        // accepts new clients
+        int fd;
+        while ((fds[0].revents & POLLIN) && (fd = accept(listener, NULL, NULL)) >= 0)
+        {
+            if (fcntl(fd, F_SETFL, O_NONBLOCK) || reallocate(error, clients, (count + 1) * sizeof(client_t)))
+            {
+                close(fd);
+                continue;
+            }
+            clients = error;
+            clients[count].fd = fd;
+            clients[count].input = NULL;
+            clients[count].inputSize = 0;
+            clients[count].pending = NULL;
+            clients[count].pendingSize = 0;
+            clients[count].jobs = NULL;
+            clients[count].lastJob = NULL;
+            clients[count++].closing = false;
+        }
+    }
+
+    // workers finish requests they execute, the others are freed with clients
+    wakeFd = -1;
+    pthread_mutex_lock(&server.lock);
+    server.stopping = true;
+    pthread_cond_broadcast(&server.ready);
+    pthread_mutex_unlock(&server.lock);
+    for (int i = 0; i < numberOfWorkers; i++)
+        pthread_join(workers[i], NULL);
+
+    // memory free (requests left in queue have no client then)
+    for (int i = 0; i < count; i++)
+        Disconnect(&server, &clients[i]);
+    for (job_t *job = server.queue, *next; job != NULL; job = next)
+    {
+        next = job->nextWork;
+        free(job->request);
+        free(job);
+    }
+    free(clients);
+    free(fds);
+    close(listener);
+    close(server.wake[0]);
+    close(server.wake[1]);
+    unlink(socketPath);
+    for (int i = 0; i < model.numberOfLines; i++)
+        pthread_mutex_destroy(&server.locks[i]);
+    pthread_mutex_destroy(&server.lock);
+    pthread_cond_destroy(&server.ready);
+    free(server.locks);
+    free(server.owner);
+    MemoryReport(model.lines, model.numberOfLines);
+    FreeLines(model.lines, model.numberOfLines, false);
+
+    if (errorCode)
+        ExitFailure(errorCode);
+    return errorCode;
+}
+
+#endif
+
+// frees objects of lines (universe of batch is freed with the batch, only indexes of its view are freed here)
+static void FreeLines(line_t *lines, int numberOfLines, bool shared)
+{
+    if (shared)
+    {
+        set_t *view = (set_t *)lines[0].ref;
+        free(view->bits);
+        free(view->sorted);
+        free(view->registers);
+        free(view->signature);
+        __freeRoaring(view->roaring);
+        free(view);
+    }
+    for (int i = shared; i < numberOfLines; i++)
+    {
+        if (lines[i].type == SET)
+            FreeSet((set_t *)lines[i].ref);
+        if (lines[i].type == RELATION)
+            FreeRelation((rel_t *)lines[i].ref);
+    }
+    if (numberOfLines)
+        __freePostings(lines[0].postings);
+    free(lines); // frees pointer of poiters
+}
+
+// frees set when the last line sharing it is freed
+static void FreeSet(set_t *set)
+{
+    if (--set->references > 0)
+        return;
+    for (int i = 0; i < set->numberOfItems && set->items != NULL && !set->borrowed; i++) // symbolic sets have only ids
+        free(set->items[i]);
+    free(set->items);
+    free(set->ids);
+    free(set->index);
+    free(set->bits);
+    free(set->sorted);
+    free(set->registers);
+    free(set->signature);
+    __freeRoaring(set->roaring);
+    free(set);
+}
+
+// frees relation when the last line sharing it is freed
+static void FreeRelation(rel_t *rel)
+{
+    if (--rel->references > 0)
+        return;
+    free(rel->left);
+    free(rel->right);
+    free(rel->index);
+    __freeGraph(rel->graph);
+    free(rel->degree[0]);
+    free(rel->degree[1]);
+    free(rel);
+}
+
+// reads file, prints its lines and results of its commands, returns error code
+// if model isn't NULL, loaded lines are kept in it, if cache isn't NULL, commands use remembered results
+static int ProcessFile(FILE *fp, batch_t *batch, model_t *model, cache_t *cache)
+{
+    int numberOfLines = 0; // number of lines for array lines
+    int ch;                // char to read file by symbol
+    int sizeOfLine = 0;    // length of each line
+
+    line_t *lines; // lines from the file (pointers to sets and relations)
+    char *line;    // variable to store each line while reading the file
+
+    if (allocate(lines, sizeof(line_t))) // allocates memory for lines
+        return MEMORY_ERR;
+    if (allocate(line, sizeof(char))) // allocates memory for line
+    {
+        free(lines);
+        return MEMORY_ERR;
+    }
+
+    void *errorCheck;  // error pointer
+    int errorCode = 0; // error code
+
+    int setBegin = 0;     // index where set or relation starts
+    int commandBegin = 0; // index where command starts
+    bool shared = false;  // if universe belongs to batch
+    bool echo = model == NULL; // lines loaded for later commands aren't printed and their commands aren't executed
+
+    char **commands = NULL;   // commands read since the last line which isn't a command
+    int numberOfCommands = 0; // commands are executed together, so the ones over the same operands are fused
+
+    contents_t contents = {NULL, 0, 0}; // sets and relations loaded so far, lines with the same content share them
+    uint64_t sample[PERF_COUNTERS + 1];   // measurement of line for --perf
+
+    if (profile != NULL)
+        profile->line = 0;
+
+    while ((ch = fgetc(fp)) != EOF)
+    {
+        if (ch == '\n')
+        {
+            line[sizeOfLine] = '\0';
+            sizeOfLine = 0;
+
+            int length = strlen(line);
+            bool malformed = (length != 1 && line[1] != ' ') || line[length - 1] == ' '; // if string has space at the beginning and at the end
+
+            // results of commands are printed before the next line which isn't a command
+            if (numberOfCommands && (line[0] != CALCULATE || malformed) && (errorCode = ProcessCommands(lines, numberOfLines, commands, &numberOfCommands, cache)))
+                break;
+            if (malformed)
+            {
+                errorCode = ARGS_ERR;
+                break;
+            }
+            if ((!numberOfLines && line[0] != UNIVERSE)) // if the first set is not universum
+            {
+                errorCode = ARGS_ERR;
+                break;
+            }
+
+            if (line[0] == UNIVERSE ||
+                line[0] == SET)
+            {
+                ProfileStart(sample);
+                setBegin = numberOfLines; // assigns index of set
+                lines[numberOfLines].type = SET;
+                lines[numberOfLines].fingerprint = __fingerprint(line);
+                lines[numberOfLines].postings = NULL;
+
+                if ((numberOfLines && line[0] == UNIVERSE)) // if we found the second universum
+                {
+                    errorCode = ARGS_ERR;
+                    break;
+                }
+
+                // files of batch with the same universe line share its object
+                if (line[0] == UNIVERSE && batch != NULL)
+                {
+                    if ((errorCode = SharedUniverse(batch, line, &lines[numberOfLines].ref)))
+                        break;
+                    shared = true;
+                }
+                // validates and creates new object of set and put its pointer into the lines
+                else if ((errorCode = ValidatesStringSet(line, &lines[numberOfLines].ref, (line[0] == UNIVERSE ? NULL : (set_t *)lines[0].ref))))
+                    break;
+
+                /*  prints out set  */
+                if (echo && line[0] == SET)
+                    NewLine();
+
+                if (echo && line[0] == UNIVERSE)
+                    PrintUniverse((set_t *)lines[numberOfLines].ref);
+                else if (echo)
+                    PrintElements((set_t *)lines[0].ref, ((set_t *)lines[numberOfLines].ref)->ids, ((set_t *)lines[numberOfLines].ref)->numberOfItems);
+
+                numberOfLines++;
+                if (line[0] == SET && (errorCode = __deduplicate(&contents, lines, numberOfLines - 1)))
+                    break;
+                if (sketchOnLoad && (errorCode = __sketch((set_t *)lines[numberOfLines - 1].ref)))
+                    break;
+                ProfileStop(sample, line[0] == UNIVERSE ? "parse-universe" : "parse-set", true);
+            }
+            else if (line[0] == RELATION)
+            {
+                ProfileStart(sample);
+                setBegin = numberOfLines; // assigns index of relation
+                lines[numberOfLines].type = line[0];
+                lines[numberOfLines].fingerprint = __fingerprint(line);
+                lines[numberOfLines].postings = NULL;
+
+                // validates and creates new object of relation and put its pointer into the lines
+                if ((errorCode = ValidatesStringRelation(line, &lines[numberOfLines].ref, (set_t *)lines[0].ref)))
+                    break;
+                /*  prints out relation  */
+                if (echo)
+                {
+                    NewLine();
+                    PrintTag(RELATION);
+                    for (int i = 0; i < ((rel_t *)(lines[numberOfLines].ref))->numberOfPairs; i++)
+                        PrintPair((set_t *)lines[0].ref, ((rel_t *)(lines[numberOfLines].ref))->left[i], ((rel_t *)(lines[numberOfLines].ref))->right[i]);
+                }
+
+                numberOfLines++;
+                if ((errorCode = __deduplicate(&contents, lines, numberOfLines - 1)))
+                    break;
+                ProfileStop(sample, "parse-relation", true);
+            }
+            else if (line[0] == CALCULATE)
+            {
+                commandBegin = numberOfLines; // assigns index of command
+
+                // keeps command until the last command is read
+                if (echo)
+                {
+                    if (reallocate(errorCheck, commands, (numberOfCommands + 1) * sizeof(char *)))
+                    {
+                        errorCode = MEMORY_ERR;
+                        break;
+                    }
+                    commands = errorCheck;
+                    if (allocate(commands[numberOfCommands], length + 1))
+                    {
+                        errorCode = MEMORY_ERR;
+                        break;
+                    }
+                    strcpy(commands[numberOfCommands++], line);
+                }
+            }
+            else
+            {
+                errorCode = ARGS_ERR;
+            }
+
+            // if user declared sets or relations after commands
+            if (commandBegin && commandBegin == setBegin)
+            {
+                errorCode = ARGS_ERR;
+                break;
+            }
+            if (errorCode || (errorCode = Govern(lines, numberOfLines, cache)))
+                break;
+        }
+        else
+        {
+            line[sizeOfLine++] = ch;
+
+            // resizes line
+            if (reallocate(errorCheck, line, (sizeOfLine + 1) * sizeof(char)))
+            {
+                errorCode = MEMORY_ERR;
+                break;
+            }
+            line = errorCheck; // if there wasnt any error, then error check has reference to newly reallocated memory
+        }
+
+        if (numberOfLines >= MAX_LINES)
+        {
+            errorCode = ARGS_ERR;
+            break;
+        }
+        // resizes lines
+        if (reallocate(errorCheck, lines, (numberOfLines + 1) * sizeof(line_t)))
+        {
+            errorCode = MEMORY_ERR;
+            break;
+        }
+        lines = errorCheck;
+    }
+
+    // executes commands at the end of file
+    if (numberOfCommands && !errorCode)
+        errorCode = ProcessCommands(lines, numberOfLines, commands, &numberOfCommands, cache);
+    for (int i = 0; i < numberOfCommands; i++)
+        free(commands[i]);
+    free(commands);
+
+    // if user declared 1 line or didn't declare any commands (unless lines are loaded for later commands)
+    if (!errorCode && (numberOfLines < 2 || (!commandBegin && model == NULL)))
+    {
+        errorCode = ARGS_ERR;
+    }
+
+    // memory free
+    free(line);
+    free(contents.slots);
+    if (model != NULL && !errorCode)
+    {
+        // lines stay loaded for commands coming later
+        model->lines = lines;
+        model->numberOfLines = numberOfLines;
+    }
+    else
+    {
+        MemoryReport(lines, numberOfLines);
+        FreeLines(lines, numberOfLines, shared);
+    }
+
+    return errorCode;
+}
+
+// parses universe line which batch doesn't have yet and puts its universe into universe
+static int __addUniverse(batch_t *batch, char *str, uint32_t hash, universe_t **universe)
+{
+    universe_t *added;
+    void *error; // error pointer
+    int errorCode;
+
+    if (reallocate(error, batch->universes, (batch->count + 1) * sizeof(universe_t)))
+        return MEMORY_ERR;
+    batch->universes = error;
+    added = &batch->universes[batch->count];
+
+    // copies line before it's split by strtok_r
+    if (allocate(added->line, strlen(str) + 1))
+        return MEMORY_ERR;
+    strcpy(added->line, str);
+
+    if ((errorCode = ValidatesStringSet(str, (void **)&added->set, NULL)))
+    {
+        free(added->line);
+        return errorCode;
+    }
+    // hash index is built before files of other threads look up their elements in it
+    __indexOf(added->set, "");
+    if (added->set->index == NULL)
+    {
+        for (int i = 0; i < added->set->numberOfItems; i++)
+            free(added->set->items[i]);
+        free(added->set->items);
+        free(added->set->ids);
+        free(added->set);
+        free(added->line);
+        return MEMORY_ERR;
+    }
+    added->hash = hash;
+    batch->count++;
+    *universe = added;
+    return EXIT_SUCCESS;
+}
+
+// puts view of universe of batch for the universe line into ref, the line is parsed only when it's seen for the
+// first time. View shares names, ids and hash index of universe, indexes built later belong to the file
+static int SharedUniverse(batch_t *batch, char *str, void **ref)
+{
+    uint32_t hash = __hash(str);
+    universe_t *universe = NULL;
+    set_t *view;
+    int errorCode = 0;
+
+    if (allocate(view, sizeof(set_t)))
+        return MEMORY_ERR;
+
+    pthread_mutex_lock(&batch->lock);
+    for (int i = 0; i < batch->count && universe == NULL; i++)
+        if (batch->universes[i].hash == hash && !strcmp(batch->universes[i].line, str))
+            universe = &batch->universes[i];
+
+    if (universe == NULL)
+        errorCode = __addUniverse(batch, str, hash, &universe);
+    if (!errorCode) // universes can be reallocated by other threads once the lock is released
+        *view = *universe->set;
+    pthread_mutex_unlock(&batch->lock);
+
+    if (errorCode)
+    {
+        free(view);
+        return errorCode;
+    }
+    view->bits = NULL;
+    view->sorted = NULL;
+    view->registers = NULL;
+    view->signature = NULL;
+    view->roaring = NULL;
+    view->references = 1;
+    *ref = view;
+    return EXIT_SUCCESS;
+}
+
+// loads lines of file into model, they aren't printed
+static int LoadModel(FILE *fp, model_t *model)
+{
+    return ProcessFile(fp, NULL, model, NULL);
+}
+
+// executes command over lines of model, returns its result as it would be printed (NULL if there was an error)
+static char *Execute(model_t *model, char *command, int *errorCode)
+{
+    FILE *previous = output;
+    char *result = NULL;
+    size_t size = 0;
+    char operation[MAX_LENGTH + 1];
+    uint64_t sample[PERF_COUNTERS + 1]; // measurement of command for --perf
+
+    if ((output = open_memstream(&result, &size)) == NULL)
+    {
+        output = previous;
+        *errorCode = MEMORY_ERR;
+        return NULL;
+    }
+    __opcode(command, operation);
+    ProfileStart(sample);
+    ProcessCal(model->lines, model->numberOfLines, command, NULL, errorCode);
+    ProfileStop(sample, operation, true);
+    fclose(output);
+    output = previous;
+
+    if (*errorCode)
+    {
+        free(result);
+        return NULL;
+    }
+    return result;
+}
+
+#ifndef SETCAL_LIBRARY
+/*
+ * Starts --perf mode. Hardware counters of the process are opened one by one,
+ * counters which can't be opened (e.g. in containers or without permission)
+ * are left out and only time is measured then. Returns error code.
+ */
+static int ProfileOpen(void)
+{
+    if (profile != NULL)
+        return 0;
+    if ((profile = calloc(1, sizeof(profile_t))) == NULL)
+        return MEMORY_ERR;
+    for (int i = 0; i < PERF_COUNTERS; i++)
+        profile->fds[i] = -1;
+
+#ifdef __linux__
+    // hardware counters in order of values of measurements
+    static const uint32_t types[PERF_COUNTERS] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+                                                  PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE};
+    static const uint64_t configs[PERF_COUNTERS] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_L1D | PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16,
+        PERF_COUNT_HW_CACHE_LL | PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16,
+        PERF_COUNT_HW_BRANCH_MISSES};
+
+    for (int i = 0; i < PERF_COUNTERS; i++)
+    {
+        struct perf_event_attr attr;
+
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = types[i];
+        attr.config = configs[i];
+        attr.exclude_kernel = 1; // allowed with stricter perf_event_paranoid
+        attr.exclude_hv = 1;
+        profile->fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+#endif
+    return 0;
+}
+#endif
+
+// reads time and counters into sample
+static void ProfileStart(uint64_t *sample)
+{
+    struct timespec now;
+
+    if (profile == NULL)
+        return;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    sample[0] = (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+    for (int i = 0; i < PERF_COUNTERS; i++)
+        if (profile->fds[i] < 0 || read(profile->fds[i], &sample[i + 1], sizeof(uint64_t)) != sizeof(uint64_t))
+            sample[i + 1] = 0;
+}
+
+// adds difference since ProfileStart to phase or operation name, measurement of a line of file can be an outlier
+static void ProfileStop(uint64_t *sample, const char *name, bool line)
+{
+    uint64_t end[PERF_COUNTERS + 1];
+    int i;
+
+    if (profile == NULL)
+        return;
+    ProfileStart(end);
+    for (i = 0; i <= PERF_COUNTERS; i++)
+        sample[i] = end[i] - sample[i];
+
+    for (i = 0; i < profile->numberOfOpcodes && strcmp(profile->opcodes[i].name, name); i++)
+        ;
+    if (i == profile->numberOfOpcodes && i < PERF_OPCODES)
+    {
+        strcpy(profile->opcodes[i].name, name);
+        profile->numberOfOpcodes++;
+    }
+    if (i < profile->numberOfOpcodes)
+    {
+        profile->opcodes[i].count++;
+        for (int j = 0; j <= PERF_COUNTERS; j++)
+            profile->opcodes[i].values[j] += sample[j];
+    }
+    if (!line)
+        return;
+
+    // keeps the slowest lines sorted by time
+    profile->line++;
+    for (i = profile->numberOfOutliers; i > 0 && profile->outliers[i - 1].values[0] < sample[0]; i--)
+        if (i < PERF_OUTLIERS)
+            profile->outliers[i] = profile->outliers[i - 1];
+    if (i < PERF_OUTLIERS)
+    {
+        profile->outliers[i].line = profile->line;
+        strcpy(profile->outliers[i].name, name);
+        memcpy(profile->outliers[i].values, sample, sizeof(profile->outliers[i].values));
+        if (profile->numberOfOutliers < PERF_OUTLIERS)
+            profile->numberOfOutliers++;
+    }
+}
+
+#ifndef SETCAL_LIBRARY
+// prints measurements of phases and operations and the slowest lines on standard error
+static void ProfileReport(void)
+{
+    static const char *columns[PERF_COUNTERS] = {"cycles", "instructions", "l1d-misses", "llc-misses", "branch-misses"};
+    bool counters = false;
+
+    if (profile == NULL)
+        return;
+    for (int i = 0; i < PERF_COUNTERS; i++)
+        counters |= profile->fds[i] >= 0;
+    if (!counters)
+        fprintf(stderr, "perf: hardware counters aren't available, only time is measured\n");
+
+    fprintf(stderr, "%-16s %10s %14s", "opcode", "count", "ns");
+    for (int i = 0; i < PERF_COUNTERS; i++)
+        if (profile->fds[i] >= 0)
+            fprintf(stderr, " %14s", columns[i]);
+    for (int k = 0; k < profile->numberOfOpcodes; k++)
+    {
+        fprintf(stderr, "\n%-16s %10ld", profile->opcodes[k].name, profile->opcodes[k].count);
+        for (int i = 0; i <= PERF_COUNTERS; i++)
+            if (!i || profile->fds[i - 1] >= 0)
+                fprintf(stderr, " %14llu", (unsigned long long)profile->opcodes[k].values[i]);
+    }
+
+    fprintf(stderr, "\n\n%-16s %10s %14s", "opcode", "line", "ns");
+    for (int i = 0; i < PERF_COUNTERS; i++)
+        if (profile->fds[i] >= 0)
+            fprintf(stderr, " %14s", columns[i]);
+    for (int k = 0; k < profile->numberOfOutliers; k++)
+    {
+        fprintf(stderr, "\n%-16s %10d", profile->outliers[k].name, profile->outliers[k].line);
+        for (int i = 0; i <= PERF_COUNTERS; i++)
+            if (!i || profile->fds[i - 1] >= 0)
+                fprintf(stderr, " %14llu", (unsigned long long)profile->outliers[k].values[i]);
+    }
+    fputc('\n', stderr);
+}
+
+// closes counters of --perf mode
+static void FreeProfile(void)
+{
+    if (profile == NULL)
+        return;
+    for (int i = 0; i < PERF_COUNTERS; i++)
+        if (profile->fds[i] >= 0)
+            close(profile->fds[i]);
+    free(profile);
+    profile = NULL;
+}
+#endif
+
+/*
+ * Keeps memory of --max-memory budget, it's checked between lines and commands.
+ * When memory in use gets over 7/8 of the budget, the cheapest representations
+ * are used first: items of sets point to names of universe instead of their own
+ * copies, then results remembered from the previous run which weren't used are
+ * evicted and finally indexes which are rebuilt on demand are dropped. Once sets
+ * were compacted, sets loaded later are compacted right away, so that the next
+ * lines reuse freed memory. The next pass is made when memory grows by 1/16 of
+ * the budget. Returns error if memory in use is over the budget.
+ */
+static int Govern(line_t *lines, int numberOfLines, cache_t *cache)
+{
+    size_t used;
+
+    if (!budget.limit || !numberOfLines)
+        return 0;
+    if (budget.compacted)
+        budget.compacted += __compactSets(lines, numberOfLines);
+    if ((used = __memoryUsed(lines, numberOfLines, cache)) > budget.peak)
+        budget.peak = used;
+    if (used <= budget.limit - budget.limit / 8 || (used <= budget.floor + budget.limit / 16 && used <= budget.limit))
+        return 0;
+
+    for (int stage = 0; stage < 3 && used > budget.limit - budget.limit / 8; stage++)
+    {
+        if (stage == 0)
+            budget.compacted += __compactSets(lines, numberOfLines);
+        if (stage == 1 && cache != NULL)
+            budget.evicted += __evict(cache);
+        for (int i = 0; i < numberOfLines && stage == 2; i++)
+            budget.dropped += __dropIndexes(&lines[i], i == 0);
+#ifdef __GLIBC__
+        malloc_trim(0); // freed blocks are mostly small, pages they leave have to be given back to system
+#endif
+        used = __memoryUsed(lines, numberOfLines, cache);
+    }
+    budget.floor = used;
+    return used > budget.limit ? MEMORY_ERR : 0;
+}
+
+// returns bytes in use, resident memory of process on linux, otherwise they are summed over lines and results
+static size_t __memoryUsed(line_t *lines, int numberOfLines, cache_t *cache)
+{
+#ifdef __linux__
+    char buffer[128];
+    unsigned long size, resident = 0; // pages
+    int fd = open("/proc/self/statm", O_RDONLY);
+    ssize_t length = fd >= 0 ? read(fd, buffer, sizeof(buffer) - 1) : -1;
+
+    if (fd >= 0)
+        close(fd);
+    if (length > 0)
+    {
+        buffer[length] = '\0';
+        if (sscanf(buffer, "%lu %lu", &size, &resident) == 2)
+            return resident * sysconf(_SC_PAGESIZE);
+    }
+#endif
+    size_t used = numberOfLines * sizeof(line_t);
+    size_t indexes;
+
+    for (int i = 0; i < numberOfLines; i++)
+        used += __footprint(lines, i, &indexes);
+    for (int i = 0; cache != NULL && i < cache->capacity; i++)
+        used += sizeof(entry_t) + (cache->entries[i].result != NULL ? strlen(cache->entries[i].result) + 1 : 0);
+    return used;
+}
+
+// returns bytes of set or relation of line (0 if an earlier line shares it), indexes gets bytes of its indexes
+static size_t __footprint(line_t *lines, int line, size_t *indexes)
+{
+    set_t *universe = (set_t *)lines[0].ref;
+    size_t bytes = 0;
+
+    *indexes = 0;
+    if (lines[line].type == SET ? ((set_t *)lines[line].ref)->references > 1 : ((rel_t *)lines[line].ref)->references > 1)
+        for (int i = 0; i < line; i++)
+            if (lines[i].ref == lines[line].ref)
+                return 0;
+
+    if (lines[line].type == SET)
+    {
+        set_t *set = (set_t *)lines[line].ref;
+
+        bytes = sizeof(set_t) + (set->numberOfItems + 1) * (sizeof(char *) + sizeof(int));
+        for (int i = 0; i < set->numberOfItems && set->items != NULL && !set->borrowed; i++)
+            bytes += strlen(set->items[i]) + 1;
+        *indexes += set->indexCapacity * sizeof(int);
+        *indexes += set->bits != NULL ? (universe->numberOfItems / 64 + 1) * sizeof(uint64_t) : 0;
+        *indexes += set->sorted != NULL ? (set->numberOfItems + 1) * sizeof(int) : 0;
+        *indexes += set->registers != NULL ? ((size_t)1 << sketchPrecision) + sketchHashes * sizeof(uint64_t) : 0;
+        for (int i = 0; set->roaring != NULL && i < set->roaring->count; i++)
+        {
+            container_t *container = &set->roaring->containers[i];
+            *indexes += sizeof(container_t) + (container->type == BITMAP_CONTAINER ? CONTAINER_SIZE / 8
+                                               : container->type == RUN_CONTAINER ? 2 * container->count * sizeof(uint16_t)
+                                                                                   : container->cardinality * sizeof(uint16_t));
+        }
+        if (line == 0 && lines[0].postings != NULL)
+            *indexes += (set->numberOfItems + 1) * sizeof(int) + lines[0].postings->start[set->numberOfItems] + 1;
+    }
+    else if (lines[line].type == RELATION)
+    {
+        rel_t *rel = (rel_t *)lines[line].ref;
+        graph_t *graph = rel->graph;
+
+        bytes = sizeof(rel_t) + rel->numberOfPairs * 2 * sizeof(uint32_t);
+        *indexes += rel->indexCapacity * sizeof(int);
+        *indexes += rel->degree[0] != NULL ? PAIR * (rel->degreeSize + 1) * sizeof(int) : 0;
+        if (graph != NULL)
+        {
+            size_t n = graph->vertices + 1;
+
+            *indexes += sizeof(graph_t) + 2 * n * sizeof(int) + 2 * (rel->numberOfPairs + 1) * sizeof(int) + (2 * n - 1) * sizeof(int);
+            *indexes += 2 * PAIR * n * sizeof(int);
+            if (graph->component != NULL) // labels of reachability
+                *indexes += 2 * n * sizeof(int) + (5 * (size_t)graph->components + 1) * sizeof(int);
+        }
+    }
+    return bytes + *indexes;
+}
+
+// frees names of sets, their items point to the same names of universe then, returns number of compacted sets
+static int __compactSets(line_t *lines, int numberOfLines)
+{
+    set_t *universe = (set_t *)lines[0].ref;
+    int compacted = 0;
+
+    // sets are compacted in order of lines, so the ones before a compacted set (which isn't shared) were compacted too
+    for (int i = numberOfLines - 1; i > 0; i--)
+    {
+        set_t *set = (set_t *)lines[i].ref;
+        if (lines[i].type != SET || set == universe)
+            continue;
+        if (set->borrowed && set->references == 1)
+            break;
+        if (set->borrowed)
+            continue;
+        for (int k = 0; k < set->numberOfItems; k++)
+        {
+            free(set->items[k]);
+            set->items[k] = universe->items[set->ids[k]];
+        }
+        set->borrowed = true;
+        compacted++;
+    }
+    return compacted;
+}
+
+// frees results remembered from the previous run which weren't used by this one, returns their number
+static int __evict(cache_t *cache)
+{
+    cache_t used = {NULL, cache->capacity, 0}; // results which stay are put into slots again
+    int evicted = cache->count;
+
+    if (!cache->capacity || (used.entries = calloc(used.capacity, sizeof(entry_t))) == NULL)
+        return 0;
+    for (int i = 0; i < cache->capacity; i++)
+        if (cache->entries[i].key && cache->entries[i].used)
+        {
+            int slot = cache->entries[i].key & (used.capacity - 1);
+            while (used.entries[slot].key)
+                slot = (slot + 1) & (used.capacity - 1);
+            used.entries[slot] = cache->entries[i];
+            used.count++;
+        }
+        else
+            free(cache->entries[i].result);
+    free(cache->entries);
+    *cache = used;
+    return evicted - used.count;
+}
+
+/*
+ * Drops indexes of set or relation of line which are built again by the next
+ * command needing them, returns their number. Hash index of universe is kept,
+ * elements of every line are looked up in it.
+ */
+static int __dropIndexes(line_t *line, bool universe)
+{
+    int dropped = 0;
+
+    if (line->type == SET)
+    {
+        set_t *set = (set_t *)line->ref;
+
+        if (set->index != NULL && !universe)
+        {
+            free(set->index);
+            set->index = NULL;
+            set->indexCapacity = 0;
+            dropped++;
+        }
+        dropped += set->bits != NULL;
+        dropped += set->sorted != NULL;
+        dropped += set->roaring != NULL;
+        free(set->bits);
+        free(set->sorted);
+        __freeRoaring(set->roaring);
+        set->bits = NULL;
+        set->sorted = NULL;
+        set->roaring = NULL;
+        if (set->registers != NULL && !sketchOnLoad) // sketches asked for by --sketch are kept
+        {
+            free(set->registers);
+            free(set->signature);
+            set->registers = NULL;
+            set->signature = NULL;
+            dropped++;
+        }
+        if (line->postings != NULL)
+        {
+            __freePostings(line->postings);
+            line->postings = NULL;
+            dropped++;
+        }
+    }
+    else if (line->type == RELATION)
+    {
+        rel_t *rel = (rel_t *)line->ref;
+
+        dropped += (rel->index != NULL) + (rel->graph != NULL) + (rel->degree[0] != NULL);
+        free(rel->index);
+        __freeGraph(rel->graph);
+        free(rel->degree[0]);
+        free(rel->degree[1]);
+        rel->index = NULL;
+        rel->indexCapacity = 0;
+        rel->graph = NULL;
+        rel->degree[0] = NULL;
+        rel->degree[1] = NULL;
+    }
+    return dropped;
+}
+
+// prints on standard error how much memory was used and which lines use the most of it
+static void MemoryReport(line_t *lines, int numberOfLines)
+{
+    int top[MEMORY_TOP]; // lines using the most memory, the largest first
+    size_t bytes[MEMORY_TOP];
+    size_t indexes[MEMORY_TOP];
+    int count = 0;
+
+    if (!budget.limit)
+        return;
+    for (int i = 0; i < numberOfLines; i++)
+    {
+        size_t index;
+        size_t size = __footprint(lines, i, &index);
+        int k = count < MEMORY_TOP ? count++ : MEMORY_TOP;
+
+        // keeps lines sorted by size
+        for (; k > 0 && bytes[k - 1] < size; k--)
+            if (k < MEMORY_TOP)
+            {
+                top[k] = top[k - 1];
+                bytes[k] = bytes[k - 1];
+                indexes[k] = indexes[k - 1];
+            }
+        if (k < MEMORY_TOP)
+        {
+            top[k] = i;
+            bytes[k] = size;
+            indexes[k] = index;
+        }
+    }
+
+    fprintf(stderr, "memory: limit %zu, peak %zu, in use %zu bytes\n", budget.limit, budget.peak,
+            __memoryUsed(lines, numberOfLines, NULL));
+    fprintf(stderr, "memory: %d sets compacted, %d indexes dropped, %d results evicted\n", budget.compacted, budget.dropped,
+            budget.evicted);
+    fprintf(stderr, "%-10s %4s %10s %14s %14s", "line", "type", "size", "bytes", "indexes");
+    for (int k = 0; k < count; k++)
+    {
+        line_t *line = &lines[top[k]];
+        fprintf(stderr, "\n%-10d %4c %10d %14zu %14zu", top[k] + 1, top[k] ? line->type : UNIVERSE,
+                line->type == SET ? ((set_t *)line->ref)->numberOfItems : ((rel_t *)line->ref)->numberOfPairs, bytes[k], indexes[k]);
+    }
+    fputc('\n', stderr);
+}
+
+// writes operation of command "C operation ..." into name (at most MAX_LENGTH chars)
+static void __opcode(const char *str, char *name)
+{
+    int length = 0;
+
+    if (str[0] && str[1] == ' ')
+        for (str += 2; str[length] && str[length] != ' ' && length < MAX_LENGTH; length++)
+            name[length] = str[length];
+    name[length] = '\0';
+}
+
+// converts string into set
+static set_t *Save(char *str, int *errorCode)
+{
+    set_t *set; // variable to store new set
+    char *pch;  // variable to keep results of strtok_r
+    char *rest; // position of strtok_r in str
+
+    if (allocate(set, sizeof(set_t))) // allocates memory for set
+    {
+        *errorCode = MEMORY_ERR;
+        return NULL;
+    }
+    set->numberOfItems = 0;                   // resets count of the elements
+    set->ids = NULL;                          // ids are assigned when set is validated
+    set->index = NULL;                        // index is built on first lookup
+    set->indexCapacity = 0;
+    set->bits = NULL;                         // bitmap and sorted ids are built on first comparison of many sets
+    set->sorted = NULL;
+    set->registers = NULL;                    // sketches are built at load (--sketch) or on first approximate command
+    set->signature = NULL;
+    set->roaring = NULL;                      // compressed bitmap is built on first lookup in a larger set
+    set->references = 1;
+    set->negated = false;
+    set->borrowed = false;                    // items are copied until memory is short (--max-memory)
+    if (allocate(set->items, sizeof(char *))) // allocates memory for set items
+    {
+        free(set);
+        *errorCode = MEMORY_ERR;
+        return NULL;
+    }
+    void *error; // error pointer
+
+    pch = strtok_r(str, SPACE, &rest);
+
+    while ((pch = strtok_r(NULL, SPACE, &rest)) != NULL)
+    {
+        if (strlen(pch) > MAX_LENGTH) // if length of pch is greater than 30
+        {
+            *errorCode = ARGS_ERR;
+            break;
+        }
+        for (int i = 0; i < RESTRICTED_COUNT; i++) // if element is one of restricted words
+        {
+            if (!strcmp(pch, RESTRICTED[i]))
+            {
+                *errorCode = ARGS_ERR;
+                break;
+            }
+        }
+        if (allocate(set->items[set->numberOfItems], strlen(pch) + 1)) // allocates memory for one element
+        {
+            *errorCode = MEMORY_ERR;
+            break;
+        }
+        strcpy(set->items[set->numberOfItems], pch); // copies element into the object
+        set->numberOfItems++;
+
+        // resizes items of set
+        if (reallocate(error, set->items, (set->numberOfItems + 1) * sizeof(char *)))
+        {
+            *errorCode = MEMORY_ERR;
+            break;
+        }
+        set->items = error;
+    }
+
+    // free
+
+    // if there is an error
+    if (*errorCode)
+    {
+        for (int i = 0; i < set->numberOfItems; i++)
+            free(set->items[i]);
+        free(set->items);
+        free(set);
+
+        return NULL;
+    }
+
+    return set;
+}
+
+// assigns universe indexes to items of set (universe gets its own positions), returns error if item isn't in universe
+static int __identify(set_t *set, set_t *universe)
+{
+    if (allocate(set->ids, (set->numberOfItems + 1) * sizeof(int)))
+        return MEMORY_ERR;
+    for (int i = 0; i < set->numberOfItems; i++)
+        if ((set->ids[i] = (universe == NULL ? i : __indexOf(universe, set->items[i]))) < 0)
+        {
+            free(set->ids);
+            return ARGS_ERR;
+        }
+    return EXIT_SUCCESS;
+}
+
+// checks if elements in set are equal and computes fingerprint of its elements (set must be identified)
+static int CheckSameElems(set_t *set, set_t *universe)
+{
+    uint64_t *keys;
+    int errorCode = EXIT_SUCCESS;
+
+    if (allocate(keys, (set->numberOfItems + 1) * sizeof(uint64_t)))
+        return MEMORY_ERR;
+    for (int i = 0; i < set->numberOfItems; i++)
+        keys[i] = set->ids[i];
+
+    if (universe != NULL)
+        errorCode = __distinct(keys, set->numberOfItems);
+    else // universe has its own positions, so its items are found by its index, which finds the first of equal items
+        for (int i = 0; i < set->numberOfItems && !errorCode; i++)
+            if (__indexOf(set, set->items[i]) != i)
+                errorCode = ARGS_ERR;
+    if (!errorCode)
+        __digest(keys, set->numberOfItems, set->digest);
+    free(keys);
+    return errorCode;
+}
+
+// returns error if some key repeats (temporary hash table, so it takes linear time)
+static int __distinct(uint64_t *keys, int count)
+{
+    int capacity = 1;
+    int *slots; // index of key + 1, 0 is an empty slot
+
+    while (capacity < 2 * count)
+        capacity <<= 1;
+    if ((slots = calloc(capacity, sizeof(int))) == NULL)
+        return MEMORY_ERR;
+    for (int i = 0; i < count; i++)
+    {
+        int slot = __mix(keys[i]) & (capacity - 1);
+        for (; slots[slot]; slot = (slot + 1) & (capacity - 1))
+            if (keys[slots[slot] - 1] == keys[i])
+            {
+                free(slots);
+                return ARGS_ERR;
+            }
+        slots[slot] = i + 1;
+    }
+    free(slots);
+    return EXIT_SUCCESS;
+}
+
+// computes 128-bit fingerprint of keys, sums of hashes don't depend on order of keys
+static void __digest(uint64_t *keys, int count, uint64_t *digest)
+{
+    digest[0] = __mix(count);
+    digest[1] = __mix(count ^ 0x9e3779b97f4a7c15ULL);
+    for (int i = 0; i < count; i++)
+    {
+        digest[0] += __mix(keys[i] + 0x632be59bd9b4e019ULL);
+        digest[1] += __mix(keys[i] ^ 0xd6e8feb86659fd93ULL);
+    }
+}
+
+// returns fingerprint of content of set or relation of line
+static uint64_t *__digestOf(line_t *line)
+{
+    return line->type == SET ? ((set_t *)line->ref)->digest : ((rel_t *)line->ref)->digest;
+}
+
+// makes line share object of an earlier set or relation with the same content, or remembers its content
+static int __deduplicate(contents_t *contents, line_t *lines, int line)
+{
+    uint64_t *digest = __digestOf(&lines[line]);
+    int slot;
+
+    // keeps table at most half full
+    if (2 * (contents->count + 1) > contents->capacity)
+    {
+        int capacity = contents->capacity ? 2 * contents->capacity : 64;
+        int *slots;
+
+        if ((slots = calloc(capacity, sizeof(int))) == NULL)
+            return MEMORY_ERR;
+        for (int i = 0; i < contents->capacity; i++)
+            if (contents->slots[i])
+            {
+                for (slot = __digestOf(&lines[contents->slots[i] - 1])[0] & (capacity - 1); slots[slot]; slot = (slot + 1) & (capacity - 1))
+                    ;
+                slots[slot] = contents->slots[i];
+            }
+        free(contents->slots);
+        contents->slots = slots;
+        contents->capacity = capacity;
+    }
+
+    for (slot = digest[0] & (contents->capacity - 1); contents->slots[slot]; slot = (slot + 1) & (contents->capacity - 1))
+    {
+        line_t *other = &lines[contents->slots[slot] - 1];
+
+        if (other->type != lines[line].type || memcmp(__digestOf(other), digest, 2 * sizeof(uint64_t)))
+            continue;
+        // the same fingerprint is confirmed by content, colliding lines keep their own objects
+        if (lines[line].type == SET ? !__equals((set_t *)lines[line].ref, (set_t *)other->ref)
+                                    : !__relEquals((rel_t *)lines[line].ref, (rel_t *)other->ref))
+            continue;
+        if (lines[line].type == SET)
+        {
+            FreeSet((set_t *)lines[line].ref);
+            ((set_t *)other->ref)->references++;
+        }
+        else
+        {
+            FreeRelation((rel_t *)lines[line].ref);
+            ((rel_t *)other->ref)->references++;
+        }
+        lines[line].ref = other->ref;
+        return EXIT_SUCCESS;
+    }
+    contents->slots[slot] = line + 1;
+    contents->count++;
+    return EXIT_SUCCESS;
+}
+
+// validates set
+static int ValidatesStringSet(char *str, void **ref, set_t *universe)
+{
+
+    int length = strlen(str);
+
+    int errorCode = 0;
+    if (universe != NULL && str[0] == UNIVERSE) // if universum isn't null and the string is for universum it means that it's the second universum
+    {
+
+        return ARGS_ERR;
+    }
+    if (length == 1)
+    {
+        *ref = Save(str, &errorCode); // creates pointer to the structure
+        if (errorCode || (errorCode = __identify((set_t *)*ref, universe)))
+            return errorCode;
+        __digest(NULL, 0, ((set_t *)*ref)->digest);
+
+        return EXIT_SUCCESS;
+    }
+    for (int i = 1; i < length; i++) // if string has digits and etc..
+    {
+        if ((str[i] == ' ' && str[i - 1] == ' ') || !((str[i] >= 'A' && str[i] <= 'Z') || (str[i] >= 'a' && str[i] <= 'z') || str[i] == ' ')) // if string has 2 spaces in a row
+        {
+            errorCode = ARGS_ERR;
+            break;
+        }
+    }
+
+    if (errorCode) // if there was an error
+    {
+        return errorCode;
+    }
+
+    *ref = Save(str, &errorCode); // creates pointer to the structure
+
+    set_t *set = (set_t *)*ref;
+    if (errorCode) // if there was an error
+    {
+        return errorCode;
+    }
+
+    // checks if all the elements are in universum
+    if ((errorCode = __identify(set, universe)))
+    {
+        for (int i = 0; i < set->numberOfItems; i++)
+        {
+            free(set->items[i]);
+        }
+        free(set->items);
+        free(set);
+        return errorCode;
+    }
+
+    // checks if set has same elements
+    if ((errorCode = CheckSameElems(set, universe)))
+    {
+        free(set->ids);
+        free(set->index);
+        for (int i = 0; i < set->numberOfItems; i++)
+        {
+            free(set->items[i]);
+        }
+        free(set->items);
+        free(set);
+        return errorCode;
+    }
+    return EXIT_SUCCESS;
+}
+
+// validates string relation
+static int ValidatesStringRelation(char *str, void **ref, set_t *universe)
+{
+
+    int length = strlen(str);
+    int errorCode = 0; // error code
+
+    if (length == 1)
+    {
+        *ref = SaveRelation(str, universe, &errorCode); // creates a pointer to an object
+        if (!errorCode)
+            __digest(NULL, 0, ((rel_t *)*ref)->digest);
+
+        return EXIT_SUCCESS;
+    }
+    for (int i = 1; i < length; i++)
+    {
+        if ((str[i] == ' ' && str[i - 1] == ' ') || !((str[i] >= 'A' && str[i] <= 'Z') || (str[i] >= 'a' && str[i] <= 'z') || str[i] == ' ' || str[i] == '(' || str[i] == ')')) // if string has 2 spaces in a row
+        {
+            errorCode = ARGS_ERR;
+            break;
+        }
+    }
+
+    // if there is an error
+    if (errorCode)
+        return errorCode;
+
+    *ref = SaveRelation(str, universe, &errorCode); // creates a pointer to an object
+
+    rel_t *rel = (rel_t *)*ref;
+
+    if (errorCode)
+        return errorCode;
+    // checks if relation has the same pairs
+    uint64_t *keys; // pairs as numbers of universe indexes
+    if (allocate(keys, (rel->numberOfPairs + 1) * sizeof(uint64_t)))
+        errorCode = MEMORY_ERR;
+    for (int i = 0; i < rel->numberOfPairs && !errorCode; i++)
+        keys[i] = (uint64_t)rel->left[i] * universe->numberOfItems + rel->right[i];
+    if (!errorCode && !(errorCode = __distinct(keys, rel->numberOfPairs)))
+        __digest(keys, rel->numberOfPairs, rel->digest);
+    free(keys);
+    if (errorCode)
+    {
+        free(rel->left);
+        free(rel->right);
+        free(rel);
+        return errorCode;
+    }
+    return EXIT_SUCCESS;
+}
+
+// converts string into relation, elements of pairs are stored as their universe indexes
+static rel_t *SaveRelation(char *str, set_t *universe, int *errorCode)
+{
+    char *pch;
+    char *rest;           // position of strtok_r in str
+    char *element = NULL; // first element of the pair being read
+    int capacity = 1;     // number of pairs columns have room for
+    int first, second;
+    rel_t *rel;
+
+    if (allocate(rel, sizeof(rel_t)))
+    {
+        *errorCode = MEMORY_ERR;
+        return NULL;
+    }
+    rel->left = malloc(capacity * sizeof(uint32_t));
+    rel->right = malloc(capacity * sizeof(uint32_t));
+    if (rel->left == NULL || rel->right == NULL)
+    {
+        free(rel->left);
+        free(rel->right);
+        free(rel);
+        *errorCode = MEMORY_ERR;
+        return NULL;
+    }
+
+    void *error; // error pointer
+
+    pch = strtok_r(str, SPACE, &rest);
+
+    int numOfElems = 0;     // number of pairs in relation
+    rel->numberOfPairs = 0; // resets number of pairs
+    rel->graph = NULL;      // graph is built on first query
+    rel->index = NULL;      // index is built on first lookup of pair
+    rel->degree[0] = NULL;  // degrees are counted on first query
+    rel->degree[1] = NULL;
+    rel->degreeSize = 0;
+    rel->loops = 0;
+    rel->indexCapacity = 0;
+    rel->references = 1;
+
+    while ((pch = strtok_r(NULL, SPACE, &rest)) != NULL)
+    {
+        int length = strlen(pch);
+
+        if (length - 1 > MAX_LENGTH)
+        {
+            *errorCode = ARGS_ERR;
+            break;
+        }
+
+        if (numOfElems % 2 == 0)
+        {
+            // validates pair in relation, the first element is looked up with the second one
+            if (pch[0] != '(')
+            {
+                *errorCode = ARGS_ERR;
+                break;
+            }
+            element = pch + 1; // removes ( from the first element
+        }
+        else
+        {
+            // removes ) from the second element
+            if (pch[length - 1] != ')')
+            {
+                *errorCode = ARGS_ERR;
+                break;
+            }
+            pch[length - 1] = '\0';
+
+            // checks if elements of pair are in universe (so they aren't restricted names either)
+            if ((first = __indexOf(universe, element)) < 0 || (second = __indexOf(universe, pch)) < 0)
+            {
+                *errorCode = ARGS_ERR;
+                break;
+            }
+            // resizes columns
+            if (rel->numberOfPairs == capacity)
+            {
+                capacity *= 2;
+                if (reallocate(error, rel->left, capacity * sizeof(uint32_t)))
+                {
+                    *errorCode = MEMORY_ERR;
+                    break;
+                }
+                rel->left = error;
+                if (reallocate(error, rel->right, capacity * sizeof(uint32_t)))
+                {
+                    *errorCode = MEMORY_ERR;
+                    break;
+                }
+                rel->right = error;
+            }
+            rel->left[rel->numberOfPairs] = first;
+            rel->right[rel->numberOfPairs++] = second;
+        }
+        numOfElems++;
+    }
+
+    // the last pair without second element is left out, but its element mustn't be a restricted name
+    for (int i = 0; i < RESTRICTED_COUNT && numOfElems % 2 && !*errorCode; i++)
+        if (!strcmp(RESTRICTED[i], element))
+            *errorCode = ARGS_ERR;
+
+    // if there was an error
+    if (*errorCode)
+    {
+        free(rel->left);
+        free(rel->right);
+        free(rel);
+        return NULL;
+    }
+
+    return rel;
+}
+
+// calculates sets & rels
+static void ProcessCal(line_t *lines, int numberOfLines, char *str, cache_t *cache, int *errorCode)
+{
+    int num;     // temp argument
+    int first;   // first line of argument range
+    int last;    // last line of argument range
+    char *pch;   // pointer for strtok_r
+    char *rest;  // position of strtok_r in str
+    void *error; // error pointer
+
+    cal_t cal; // object for expressions
+
+    FILE *previous = output;                              // stream for results while result is being remembered
+    char *result = NULL;                                  // result to remember
+    size_t size = 0;                                      // length of result
+    uint64_t key = cache != NULL ? __fingerprint(str) : 0; // fingerprint of command and lines it depends on
+
+    cal.argumentsCount = 0; // resets argument count
+    cal.elementsCount = 0;  // resets count of element arguments
+    cal.negations = 0;      // resets complemented arguments
+    cal.vector = -1;        // resets range of lines for each of which command is executed
+    cal.count = -1;         // resets number of elements of topk
+
+    pch = strtok_r(str, SPACE, &rest);
+
+    if ((pch = strtok_r(NULL, SPACE, &rest)) != NULL)
+    {
+        if (allocate(cal.operation, strlen(pch) + 1)) // allocates memory for operation string
+        {
+            *errorCode = MEMORY_ERR;
+            return;
+        }
+        strcpy(cal.operation, pch);
+    }
+    else // if command has no operation
+    {
+        *errorCode = ARGS_ERR;
+        return;
+    }
+
+    if (allocate(cal.arguments, sizeof(int))) // allocates memory for arguments
+    {
+        *errorCode = MEMORY_ERR;
+        return;
+    }
+
+    // reads arguments of the command, range A-B stands for lines A, A + 1, ..., B and ~A for complement of set A
+    while ((pch = strtok_r(NULL, SPACE, &rest)) != NULL)
+    {
+        if (cal.count < 0 && cal.argumentsCount == 1 && (!strcmp(cal.operation, TOPK_OUT) || !strcmp(cal.operation, TOPK_IN))) // number after relation isn't a line
+        {
+            char *end;
+            long count = strtol(pch, &end, 10);
+            if (*end != '\0' || end == pch || count < 1 || count > INT32_MAX)
+            {
+                *errorCode = ARGS_ERR;
+                break;
+            }
+            cal.count = count;
+            continue;
+        }
+        else if (__range(pch, VECTOR, &first, &last)) // command is executed for each line of A..B, it's the argument A first
+        {
+            if (cal.vector >= 0 || first < 1 || first > last || last > numberOfLines)
+            {
+                *errorCode = ARGS_ERR;
+                break;
+            }
+            cal.vector = cal.argumentsCount;
+            cal.last = last;
+            last = first;
+        }
+        else if (pch[0] == NEGATION)
+        {
+            char *end;
+            cal.negations |= 1u << cal.argumentsCount;
+            first = last = strtol(pch + 1, &end, 10);
+            if (cal.argumentsCount >= PAIR || *end != '\0' || end == pch + 1)
+            {
+                *errorCode = ARGS_ERR;
+                break;
+            }
+        }
+        else if (!__range(pch, SPAN, &first, &last) && (first = last = atoi(pch)) == 0)
+        {
+            if (cal.elementsCount < PAIR)
+                cal.elements[cal.elementsCount++] = pch; // points into str, valid until the command is executed
+            continue;
+        }
+        // a range has to be lines, a single line is checked by the command
+        if (first < 1 || first > last || (first != last && last > numberOfLines))
+        {
+            *errorCode = ARGS_ERR;
+            break;
+        }
+        if (reallocate(error, cal.arguments, (cal.argumentsCount + last - first + 2) * sizeof(int)))
+        {
+            *errorCode = MEMORY_ERR;
+            break;
+        }
+        cal.arguments = error;
+        for (num = first; num <= last; num++)
+            cal.arguments[cal.argumentsCount++] = num;
+    }
+    if (*errorCode)
+    {
+        free(cal.operation);
+        free(cal.arguments);
+        return;
+    }
+
+    // command depends on universe and its arguments, if none of them changed, its result is printed again
+    if (cache != NULL)
+    {
+        entry_t *entry;
+
+        key = __mix(key ^ lines[0].fingerprint);
+        if (sketchOnLoad) // approximate results depend on size of sketches
+            key = __mix(key ^ sketchHashes);
+        if (outputMode) // elements are printed as indexes
+            key = __mix(key ^ outputMode);
+        for (int i = 0; i < cal.argumentsCount; i++)
+            key = __mix(key ^ (cal.arguments[i] <= numberOfLines ? lines[cal.arguments[i] - 1].fingerprint : (uint64_t)cal.arguments[i]));
+        if (cal.vector >= 0) // result depends on all lines of range
+            for (int i = cal.arguments[cal.vector]; i < cal.last; i++)
+                key = __mix(key ^ lines[i].fingerprint);
+        if (!strcmp(cal.operation, SETS_CONTAINING)) // result depends on all sets
+            for (int i = 1; i < numberOfLines; i++)
+                key = __mix(key ^ lines[i].fingerprint);
+        if (!key)
+            key = 1;
+
+        if ((entry = CacheFind(cache, key)) != NULL)
+        {
+            entry->used = true;
+            fputs(entry->result, output);
+            free(cal.operation);
+            free(cal.arguments);
+            return;
+        }
+        if ((output = open_memstream(&result, &size)) == NULL) // without memory the result isn't remembered
+            output = previous;
+    }
+
+    // command execution, lines of range A..B have to be of the same type, then the command is executed for each of them
+    if (cal.vector >= 0)
+        for (int i = cal.arguments[cal.vector]; i < cal.last && !*errorCode; i++)
+            if (lines[i].type != lines[cal.arguments[cal.vector] - 1].type)
+                *errorCode = ARGS_ERR;
+    for (int line = cal.vector >= 0 ? cal.arguments[cal.vector] : 0, start = line; !*errorCode; line++)
+    {
+        if (cal.vector >= 0)
+            cal.arguments[cal.vector] = line;
+        Calculate(lines, numberOfLines, &cal, errorCode);
+        if (*errorCode || cal.vector < 0 || line == cal.last)
+            break;
+        NewLine();
+        // the first line built indexes which the other lines use, so they can be computed by more threads
+        if (line == start && profile == NULL && outputMode != OUTPUT_BINARY && strcmp(cal.operation, MATRIX))
+        {
+            CalculateRange(lines, numberOfLines, &cal, line + 1, errorCode);
+            break;
+        }
+    }
+
+    // remembers result of executed command
+    if (output != previous)
+    {
+        fclose(output);
+        output = previous;
+        if (!*errorCode && result != NULL)
+        {
+            fputs(result, output);
+            if (!CacheAdd(cache, key, result))
+                result = NULL; // result belongs to cache now
+        }
+        free(result);
+    }
+
+    free(cal.operation);
+    free(cal.arguments);
+}
+
+/*
+ * Executes command for lines first..cal->last of range A..B, results are
+ * printed in order of lines up to the first error. Lines are split between
+ * threads by their objects and each thread prints into its own buffer;
+ * operands which all lines share get their indexes before, so threads only
+ * read them. A short range is executed by the calling thread alone.
+ */
+static void CalculateRange(line_t *lines, int numberOfLines, cal_t *cal, int first, int *errorCode)
+{
+    vector_t vector = {lines, numberOfLines, cal, first, 0, NULL, NULL, NULL, NULL, NULL};
+    int count = cal->last - first + 1;
+    long cost = 0; // size of lines of range
+
+    for (int line = first; line <= cal->last; line++)
+        cost += lines[line - 1].type == SET ? ((set_t *)lines[line - 1].ref)->numberOfItems
+                                            : ((rel_t *)lines[line - 1].ref)->numberOfPairs;
+    if ((vector.buckets = __parts(count, cost)) < 2)
+    {
+        for (int line = first; line <= cal->last && !*errorCode; line++)
+        {
+            cal->arguments[cal->vector] = line;
+            Calculate(lines, numberOfLines, cal, errorCode);
+            if (!*errorCode && line < cal->last)
+                NewLine();
+        }
+        return;
+    }
+
+    if ((*errorCode = __warm(lines, numberOfLines, cal)) ||
+        allocate(vector.texts, vector.buckets * sizeof(char *)) ||
+        allocate(vector.sizes, vector.buckets * sizeof(size_t)) ||
+        allocate(vector.starts, count * sizeof(size_t)) ||
+        allocate(vector.ends, count * sizeof(size_t)) ||
+        allocate(vector.errors, count * sizeof(int)))
+    {
+        *errorCode = MEMORY_ERR;
+        free(vector.texts);
+        free(vector.sizes);
+        free(vector.starts);
+        free(vector.ends);
+        return;
+    }
+    __parallel(__rangeLines, &vector, vector.buckets, vector.buckets);
+
+    for (int line = first; line <= cal->last; line++)
+    {
+        int i = line - first;
+
+        if (vector.ends[i] > vector.starts[i])
+            fwrite(vector.texts[__bucket(&lines[line - 1], vector.buckets)] + vector.starts[i], 1, vector.ends[i] - vector.starts[i], output);
+        if ((*errorCode = vector.errors[i]))
+            break;
+        if (line < cal->last)
+            NewLine();
+    }
+    for (int i = 0; i < vector.buckets; i++)
+        free(vector.texts[i]);
+    free(vector.texts);
+    free(vector.sizes);
+    free(vector.starts);
+    free(vector.ends);
+    free(vector.errors);
+}
+
+// computes lines of buckets of part of range, each bucket is printed into its own buffer
+static void *__rangeLines(void *arg)
+{
+    part_t *part = arg;
+    vector_t *vector = part->shared;
+    cal_t cal = *vector->cal; // arguments are changed for each line
+    FILE *previous = output;
+
+    if (allocate(cal.arguments, (cal.argumentsCount + 1) * sizeof(int)))
+        cal.arguments = NULL;
+    else
+        memcpy(cal.arguments, vector->cal->arguments, cal.argumentsCount * sizeof(int));
+
+    for (int bucket = part->first; bucket < part->last; bucket++)
+    {
+        int errorCode = cal.arguments == NULL ? MEMORY_ERR : 0;
+
+        vector->texts[bucket] = NULL;
+        if (!errorCode && (output = open_memstream(&vector->texts[bucket], &vector->sizes[bucket])) == NULL)
+            errorCode = MEMORY_ERR;
+        for (int line = vector->first; line <= cal.last; line++)
+        {
+            int i = line - vector->first;
+
+            if (__bucket(&vector->lines[line - 1], vector->buckets) != bucket)
+                continue;
+            vector->starts[i] = vector->ends[i] = 0;
+            if ((vector->errors[i] = errorCode)) // lines after an error aren't printed
+                continue;
+            fflush(output);
+            vector->starts[i] = vector->sizes[bucket];
+            cal.arguments[cal.vector] = line;
+            Calculate(vector->lines, vector->numberOfLines, &cal, &vector->errors[i]);
+            fflush(output);
+            vector->ends[i] = vector->sizes[bucket];
+            errorCode = vector->errors[i];
+        }
+        if (output != previous && output != NULL)
+            fclose(output);
+        output = previous;
+    }
+    free(cal.arguments);
+    return NULL;
+}
+
+// returns bucket of line of range, lines with the same object are in the same bucket
+static int __bucket(line_t *line, int buckets)
+{
+    return __mix((uint64_t)(uintptr_t)line->ref) % buckets;
+}
+
+// builds indexes of universe and of operands of command which aren't lines of range, returns error code
+static int __warm(line_t *lines, int numberOfLines, cal_t *cal)
+{
+    set_t *universe = lines[0].ref;
+
+    for (int i = -1; i < cal->argumentsCount; i++)
+    {
+        int line = i < 0 ? 1 : cal->arguments[i];
+
+        if (i == cal->vector || line > numberOfLines) // lines of range, or a number which isn't a line
+            continue;
+        if (lines[line - 1].type == SET)
+        {
+            set_t *set = lines[line - 1].ref;
+
+            __indexOf(set, "");
+            if (set->index == NULL || __sorted(set) == NULL || __bits(set, universe) == NULL ||
+                (set->numberOfItems > SMALL_SET && __roaring(set) == NULL))
+                return MEMORY_ERR;
+        }
+        else
+        {
+            rel_t *rel = lines[line - 1].ref;
+
+            __containsPair(rel, 0);
+            if (rel->index == NULL || __degrees(rel))
+                return MEMORY_ERR;
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+// type of line which is argument i of command, or 0 if the argument isn't a line (e.g. number of elements)
+#define TYPE(i) (cal->arguments[i] <= numberOfLines ? lines[cal->arguments[i] - 1].type : 0)
+
+// executes command with read arguments
+static void Calculate(line_t *lines, int numberOfLines, cal_t *cal, int *errorCode)
+{
+    if (cal->negations)
+    {
+        if ((cal->argumentsCount == 1 || cal->argumentsCount == 2) && !cal->elementsCount && TYPE(0) == SET &&
+            TYPE(cal->argumentsCount - 1) == SET)
+            SetSymbolic(cal->operation, lines, cal->arguments, cal->argumentsCount, cal->negations, errorCode);
+        else
+            *errorCode = ARGS_ERR;
+    }
+    else if (!strcmp(cal->operation, EMPTY) && (cal->argumentsCount == 1) && (TYPE(0) == SET))
+        SetEmpty((set_t *)(lines[cal->arguments[0] - 1].ref));
+    else if (!strcmp(cal->operation, COMPLEMENT) && (cal->argumentsCount == 1) && (TYPE(0) == SET))
+        SetComplement((set_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[0].ref), errorCode);
+    else if (!strcmp(cal->operation, CARD) && (cal->argumentsCount == 1) && (TYPE(0) == SET))
+        SetCard((set_t *)(lines[cal->arguments[0] - 1].ref));
+    else if (!strcmp(cal->operation, UNION) && (cal->argumentsCount == 2) && (TYPE(0) == SET) && (TYPE(1) == SET))
+        SetUnion((set_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[cal->arguments[1] - 1].ref), (set_t *)(lines[0].ref), errorCode);
+    else if (!strcmp(cal->operation, INTERSECT) && (cal->argumentsCount == 2) && (TYPE(0) == SET) && (TYPE(1) == SET))
+        SetIntersect((set_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[cal->arguments[1] - 1].ref), (set_t *)(lines[0].ref), errorCode);
+    else if (!strcmp(cal->operation, MINUS) && (cal->argumentsCount == 2) && (TYPE(0) == SET) && (TYPE(1) == SET))
+        SetMinus((set_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[cal->arguments[1] - 1].ref), (set_t *)(lines[0].ref), errorCode);
+    else if (!strcmp(cal->operation, SUBSETEQ) && (cal->argumentsCount == 2) && (TYPE(0) == SET) && (TYPE(1) == SET))
+        SetSubseteq((set_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[cal->arguments[1] - 1].ref));
+    else if (!strcmp(cal->operation, SUBSET) && (cal->argumentsCount == 2) && (TYPE(0) == SET) && (TYPE(1) == SET))
+        SetSubset((set_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[cal->arguments[1] - 1].ref));
+    else if (!strcmp(cal->operation, EQUALS) && (cal->argumentsCount == 2) && (TYPE(0) == SET) && (TYPE(1) == SET))
+        SetEquals((set_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[cal->arguments[1] - 1].ref));
+    else if (!strcmp(cal->operation, UNION) && (cal->argumentsCount == 2) && (TYPE(0) == RELATION) && (TYPE(1) == RELATION))
+        RelUnion((rel_t *)(lines[cal->arguments[0] - 1].ref), (rel_t *)(lines[cal->arguments[1] - 1].ref), (set_t *)(lines[0].ref));
+    else if (!strcmp(cal->operation, INTERSECT) && (cal->argumentsCount == 2) && (TYPE(0) == RELATION) && (TYPE(1) == RELATION))
+        RelIntersect((rel_t *)(lines[cal->arguments[0] - 1].ref), (rel_t *)(lines[cal->arguments[1] - 1].ref), (set_t *)(lines[0].ref));
+    else if (!strcmp(cal->operation, MINUS) && (cal->argumentsCount == 2) && (TYPE(0) == RELATION) && (TYPE(1) == RELATION))
+        RelMinus((rel_t *)(lines[cal->arguments[0] - 1].ref), (rel_t *)(lines[cal->arguments[1] - 1].ref), (set_t *)(lines[0].ref));
+    else if (!strcmp(cal->operation, SUBSETEQ) && (cal->argumentsCount == 2) && (TYPE(0) == RELATION) && (TYPE(1) == RELATION))
+        RelSubseteq((rel_t *)(lines[cal->arguments[0] - 1].ref), (rel_t *)(lines[cal->arguments[1] - 1].ref));
+    else if (!strcmp(cal->operation, SUBSET) && (cal->argumentsCount == 2) && (TYPE(0) == RELATION) && (TYPE(1) == RELATION))
+        RelSubset((rel_t *)(lines[cal->arguments[0] - 1].ref), (rel_t *)(lines[cal->arguments[1] - 1].ref));
+    else if (!strcmp(cal->operation, EQUALS) && (cal->argumentsCount == 2) && (TYPE(0) == RELATION) && (TYPE(1) == RELATION))
+        RelEquals((rel_t *)(lines[cal->arguments[0] - 1].ref), (rel_t *)(lines[cal->arguments[1] - 1].ref));
+    else if (!strcmp(cal->operation, REFLEXIVE) && (cal->argumentsCount == 1) && (TYPE(0) == RELATION))
+        RelReflexive((rel_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[0].ref));
+    else if (!strcmp(cal->operation, SYMMETRIC) && (cal->argumentsCount == 1) && (TYPE(0) == RELATION))
+        RelSymmetric((rel_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[0].ref), errorCode);
+    else if (!strcmp(cal->operation, ANTISYMMETRIC) && (cal->argumentsCount == 1) && (TYPE(0) == RELATION))
+        RelAntisymmetric((rel_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[0].ref), errorCode);
+    else if (!strcmp(cal->operation, TRANSITIVE) && (cal->argumentsCount == 1) && (TYPE(0) == RELATION))
+        RelTransitive((rel_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[0].ref), errorCode);
+    else if (!strcmp(cal->operation, FUNCTION) && (cal->argumentsCount == 1) && (TYPE(0) == RELATION))
+        RelFunction((rel_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[0].ref), errorCode);
+    else if (!strcmp(cal->operation, DOMAIN) && (cal->argumentsCount == 1) && (TYPE(0) == RELATION))
+        RelDomain((rel_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[0].ref), errorCode);
+    else if (!strcmp(cal->operation, CODOMAIN) && (cal->argumentsCount == 1) && (TYPE(0) == RELATION))
+        RelCodomain((rel_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[0].ref), errorCode);
+    else if (!strcmp(cal->operation, INJECTIVE) && (cal->argumentsCount == 3) && (TYPE(0) == RELATION) && (TYPE(1) == SET) && (TYPE(2) == SET))
+        RelInjective((rel_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[cal->arguments[1] - 1].ref), (set_t *)(lines[cal->arguments[2] - 1].ref), errorCode);
+    else if (!strcmp(cal->operation, SURJECTIVE) && (cal->argumentsCount == 3) && (TYPE(0) == RELATION) && (TYPE(1) == SET) && (TYPE(2) == SET))
+        RelSurjective((rel_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[cal->arguments[1] - 1].ref), (set_t *)(lines[cal->arguments[2] - 1].ref), errorCode);
+    else if (!strcmp(cal->operation, BIJECTIVE) && (cal->argumentsCount == 3) && (TYPE(0) == RELATION) && (TYPE(1) == SET) && (TYPE(2) == SET))
+        RelBijective((rel_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[cal->arguments[1] - 1].ref), (set_t *)(lines[cal->arguments[2] - 1].ref), errorCode);
+    else if (!strcmp(cal->operation, REACH) && (cal->argumentsCount == 1) && (cal->elementsCount == 2) && (TYPE(0) == RELATION))
+        RelReach((rel_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[0].ref), cal->elements[0], cal->elements[1], errorCode);
+    else if (!strcmp(cal->operation, DISTANCE) && (cal->argumentsCount == 1) && (cal->elementsCount == 2) && (TYPE(0) == RELATION))
+        RelDistance((rel_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[0].ref), cal->elements[0], cal->elements[1], errorCode);
+    else if (!strcmp(cal->operation, CLASSES) && (cal->argumentsCount == 1) && (TYPE(0) == RELATION))
+        RelClasses((rel_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[0].ref), errorCode);
+    else if (!strcmp(cal->operation, COMPONENTS) && (cal->argumentsCount == 1) && (TYPE(0) == RELATION))
+        RelComponents((rel_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[0].ref), errorCode);
+    else if (!strcmp(cal->operation, POSET) && (cal->argumentsCount == 1) && (TYPE(0) == RELATION))
+        RelPoset((rel_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[0].ref), errorCode);
+    else if (!strcmp(cal->operation, ACYCLIC) && (cal->argumentsCount == 1) && (TYPE(0) == RELATION))
+        RelAcyclic((rel_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[0].ref), errorCode);
+    else if (!strcmp(cal->operation, TOPOSORT) && (cal->argumentsCount == 1) && (TYPE(0) == RELATION))
+        RelToposort((rel_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[0].ref), errorCode);
+    else if (!strcmp(cal->operation, CARD_INTERSECT) && (cal->argumentsCount == 2) && (TYPE(0) == SET) && (TYPE(1) == SET))
+        SetCardIntersect((set_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[cal->arguments[1] - 1].ref), (set_t *)(lines[0].ref), errorCode);
+    else if (!strcmp(cal->operation, CARD_UNION) && (cal->argumentsCount == 2) && (TYPE(0) == SET) && (TYPE(1) == SET))
+        SetCardUnion((set_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[cal->arguments[1] - 1].ref), (set_t *)(lines[0].ref), errorCode);
+    else if (!strcmp(cal->operation, CARD_MINUS) && (cal->argumentsCount == 2) && (TYPE(0) == SET) && (TYPE(1) == SET))
+        SetCardMinus((set_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[cal->arguments[1] - 1].ref), (set_t *)(lines[0].ref), errorCode);
+    else if (!strcmp(cal->operation, JACCARD) && (cal->argumentsCount == 2) && (TYPE(0) == SET) && (TYPE(1) == SET))
+        SetJaccard((set_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[cal->arguments[1] - 1].ref), (set_t *)(lines[0].ref), errorCode);
+    else if (!strcmp(cal->operation, APPROX_CARD) && (cal->argumentsCount == 1) && (TYPE(0) == SET))
+        SetApproxCard((set_t *)(lines[cal->arguments[0] - 1].ref), errorCode);
+    else if (!strcmp(cal->operation, APPROX_UNION_CARD) && (cal->argumentsCount == 2) && (TYPE(0) == SET) && (TYPE(1) == SET))
+        SetApproxUnionCard((set_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[cal->arguments[1] - 1].ref), errorCode);
+    else if (!strcmp(cal->operation, APPROX_JACCARD) && (cal->argumentsCount == 2) && (TYPE(0) == SET) && (TYPE(1) == SET))
+        SetApproxJaccard((set_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[cal->arguments[1] - 1].ref), errorCode);
+    else if (!strcmp(cal->operation, MEMBER) && (cal->argumentsCount == 1) && (cal->elementsCount == 1) && (TYPE(0) == SET))
+        SetMember((set_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[0].ref), cal->elements[0], errorCode);
+    else if (!strcmp(cal->operation, SETS_CONTAINING) && (cal->argumentsCount == 0) && (cal->elementsCount == 1))
+        SetsContaining(lines, numberOfLines, cal->elements[0], errorCode);
+    else if (!strcmp(cal->operation, SUCC) && (cal->argumentsCount == 1) && (cal->elementsCount == 1) && (TYPE(0) == RELATION))
+        RelSucc((rel_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[0].ref), cal->elements[0], false, errorCode);
+    else if (!strcmp(cal->operation, PRED) && (cal->argumentsCount == 1) && (cal->elementsCount == 1) && (TYPE(0) == RELATION))
+        RelSucc((rel_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[0].ref), cal->elements[0], true, errorCode);
+    else if (!strcmp(cal->operation, STATS) && (cal->argumentsCount == 1) && (TYPE(0) == RELATION))
+        RelStats((rel_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[0].ref), errorCode);
+    else if (!strcmp(cal->operation, TOPK_OUT) && (cal->argumentsCount == 1) && (cal->count > 0) && (TYPE(0) == RELATION))
+        RelTopK((rel_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[0].ref), cal->count, false, errorCode);
+    else if (!strcmp(cal->operation, TOPK_IN) && (cal->argumentsCount == 1) && (cal->count > 0) && (TYPE(0) == RELATION))
+        RelTopK((rel_t *)(lines[cal->arguments[0] - 1].ref), (set_t *)(lines[0].ref), cal->count, true, errorCode);
+    else if (!strcmp(cal->operation, MATRIX) && (cal->argumentsCount >= 1) && (cal->elementsCount >= 1))
+        SetMatrix(lines, numberOfLines, cal->arguments, cal->argumentsCount, cal->elements[0], cal->elementsCount == 2 ? cal->elements[1] : NULL, errorCode);
+    else
+        *errorCode = ARGS_ERR;
+}
+#undef TYPE
+
+/*
+ * Executes commands read together and frees them. Commands over the same
+ * operands (set commands over two sets, domain, codomain and function over a
+ * relation) are grouped first: results of a group are computed by one sweep
+ * when its first command is printed, and results are printed in the order of
+ * commands. Remembered results of incremental mode are used instead of groups.
+ */
+static int ProcessCommands(line_t *lines, int numberOfLines, char **commands, int *numberOfCommands, cache_t *cache)
+{
+    int errorCode = 0;
+    int *groupOf;          // group of each command, -1 if it's executed alone
+    group_t *groups = NULL;
+    char operation[MAX_LENGTH + 1];
+    long arguments[PAIR];
+    uint64_t sample[PERF_COUNTERS + 1]; // measurement of command for --perf
+
+    if (allocate(groupOf, (*numberOfCommands + 1) * sizeof(int)))
+        errorCode = MEMORY_ERR;
+    else if (cache != NULL)
+        for (int i = 0; i < *numberOfCommands; i++)
+            groupOf[i] = -1;
+    else
+        errorCode = __plan(lines, numberOfLines, commands, *numberOfCommands, groupOf, &groups);
+
+    for (int i = 0; i < *numberOfCommands && !errorCode; i++)
+    {
+        group_t *group = groupOf[i] >= 0 ? &groups[groupOf[i]] : NULL;
+
+        NewLine();
+        if ((errorCode = Govern(lines, numberOfLines, cache)))
+            break;
+        __opcode(commands[i], operation); // commands[i] is split into words by ProcessCal
+        ProfileStart(sample);
+        if (group == NULL)
+            ProcessCal(lines, numberOfLines, commands[i], cache, &errorCode);
+        // sweep is measured with the first command of group, degrees of relation are recounted only if Govern dropped them
+        else if ((group->swept && group->operands[1]) || !(errorCode = __sweep(lines, group)))
+        {
+            __command(commands[i], operation, arguments);
+            __emit(lines, group, operation, arguments);
+            if (!--group->remaining)
+                __freeGroup(group);
+        }
+        ProfileStop(sample, operation, true);
+    }
+
+    // frees groups whose commands weren't printed because of an error
+    if (groups != NULL)
+        for (int i = 0; i < *numberOfCommands; i++)
+            if (groupOf[i] >= 0 && groups[groupOf[i]].remaining)
+            {
+                __freeGroup(&groups[groupOf[i]]);
+                groups[groupOf[i]].remaining = 0;
+            }
+    for (int i = 0; i < *numberOfCommands; i++)
+        free(commands[i]);
+    *numberOfCommands = 0;
+    free(groups);
+    free(groupOf);
+    return errorCode;
+}
+
+// reads command "C operation A" or "C operation A B", returns number of arguments or -1 if command has other form
+static int __command(const char *str, char *operation, long *arguments)
+{
+    int length = 0;
+    int count = 0;
+    char *end;
+
+    if (str[0] != CALCULATE || str[1] != ' ')
+        return -1;
+    str += 2;
+    while (str[length] && str[length] != ' ')
+        length++;
+    if (!length || length > MAX_LENGTH)
+        return -1;
+    memcpy(operation, str, length);
+    operation[length] = '\0';
+    for (str += length; *str == ' ' && count < PAIR; str = end)
+    {
+        if (str[1] < '1' || str[1] > '9')
+            return -1;
+        arguments[count++] = strtol(str + 1, &end, 10);
+    }
+    return *str ? -1 : count;
+}
+
+// assigns commands which can be fused to groups of commands over the same operands, groups of one command are left out
+static int __plan(line_t *lines, int numberOfLines, char **commands, int count, int *groupOf, group_t **groups)
+{
+    const char *setCommands[] = {UNION, INTERSECT, MINUS, SUBSETEQ, SUBSET, CARD_INTERSECT, CARD_UNION, CARD_MINUS, JACCARD};
+    const char *relationCommands[] = {DOMAIN, CODOMAIN, FUNCTION};
+    char operation[MAX_LENGTH + 1];
+    long arguments[PAIR];
+    int numberOfGroups = 0;
+    int capacity = 1;
+    int *slots; // group + 1 for operands (open addressing), 0 is an empty slot
+
+    while (capacity < 2 * count)
+        capacity <<= 1;
+    if ((slots = calloc(capacity, sizeof(int))) == NULL || allocate(*groups, (count + 1) * sizeof(group_t)))
+    {
+        free(slots);
+        return MEMORY_ERR;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        int operands[PAIR] = {0, 0};
+        int n = __command(commands[i], operation, arguments);
+        int slot;
+
+        groupOf[i] = -1;
+        if (n < 1 || arguments[0] > numberOfLines || (n == 2 && arguments[1] > numberOfLines))
+            continue;
+        if (n == 2 && lines[arguments[0] - 1].type == SET && lines[arguments[1] - 1].type == SET)
+        {
+            for (int j = 0; j < (int)(sizeof(setCommands) / sizeof(char *)); j++)
+                if (!strcmp(operation, setCommands[j]))
+                {
+                    // commands over (A B) and (B A) share one sweep
+                    operands[0] = arguments[0] < arguments[1] ? arguments[0] : arguments[1];
+                    operands[1] = arguments[0] < arguments[1] ? arguments[1] : arguments[0];
+                }
+        }
+        else if (n == 1 && lines[arguments[0] - 1].type == RELATION)
+        {
+            for (int j = 0; j < (int)(sizeof(relationCommands) / sizeof(char *)); j++)
+                if (!strcmp(operation, relationCommands[j]))
+                    operands[0] = arguments[0];
+        }
+        if (!operands[0])
+            continue;
+
+        for (slot = __mix((uint64_t)operands[0] << 32 | operands[1]) & (capacity - 1); slots[slot]; slot = (slot + 1) & (capacity - 1))
+            if ((*groups)[slots[slot] - 1].operands[0] == operands[0] && (*groups)[slots[slot] - 1].operands[1] == operands[1])
+                break;
+        if (!slots[slot])
+        {
+            group_t group = {{operands[0], operands[1]}, 0, 0, false, {NULL, NULL}, {NULL, NULL}, 0, {0, 0}};
+            (*groups)[numberOfGroups] = group;
+            slots[slot] = ++numberOfGroups;
+        }
+        groupOf[i] = slots[slot] - 1;
+        (*groups)[groupOf[i]].size++;
+        (*groups)[groupOf[i]].remaining++;
+    }
+
+    // a command without other commands over its operands is executed as usual
+    for (int i = 0; i < count; i++)
+        if (groupOf[i] >= 0 && (*groups)[groupOf[i]].size < 2)
+            groupOf[i] = -1;
+    free(slots);
+    return EXIT_SUCCESS;
+}
+
+// computes results of commands of group by one pass over its operands
+static int __sweep(line_t *lines, group_t *group)
+{
+    group->swept = true;
+    if (!group->operands[1]) // relation, counts elements of pairs
+        return __degrees((rel_t *)lines[group->operands[0] - 1].ref);
+
+    /*
+     * Sets, splits elements of each set by lookups in the other one: in its
+     * bitmap if some command built it, otherwise in its compressed bitmap, so
+     * small sets in a huge universe don't get bitmaps over the whole universe.
+     */
+    set_t *sets[PAIR] = {lines[group->operands[0] - 1].ref, lines[group->operands[1] - 1].ref};
+    for (int k = 0; k < PAIR; k++)
+        if (allocate(group->common[k], (sets[k]->numberOfItems + 1) * sizeof(int)) ||
+            allocate(group->only[k], (sets[k]->numberOfItems + 1) * sizeof(int)))
+            return MEMORY_ERR;
+    for (int k = 0; k < PAIR; k++)
+    {
+        uint64_t *bits = sets[1 - k]->bits;
+
+        group->commonCount = 0;
+        for (int i = 0; i < sets[k]->numberOfItems; i++)
+        {
+            int id = sets[k]->ids[i];
+            if (bits != NULL ? bits[id / 64] >> (id % 64) & 1 : __contains(sets[1 - k], id))
+                group->common[k][group->commonCount++] = id;
+            else
+                group->only[k][group->onlyCount[k]++] = id;
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+// prints result of command of group
+static void __emit(line_t *lines, group_t *group, char *operation, long *arguments)
+{
+    set_t *universe = lines[0].ref;
+
+    if (!group->operands[1])
+    {
+        rel_t *rel = lines[group->operands[0] - 1].ref;
+        bool function = true;
+
+        if (!strcmp(operation, FUNCTION))
+        {
+            for (int i = 0; i < rel->degreeSize; i++)
+                function = function && rel->degree[0][i] < 2;
+            fprintf(output, function ? _TRUE : _FALSE);
+            return;
+        }
+        PrintTag(SET);
+        for (int i = 0; i < rel->degreeSize; i++)
+            if (rel->degree[strcmp(operation, DOMAIN) ? 1 : 0][i])
+                PrintElement(universe, i);
+        return;
+    }
+
+    int k = arguments[0] == group->operands[0] ? 0 : 1; // position of the first argument in group
+    set_t *set1 = lines[arguments[0] - 1].ref;
+    set_t *set2 = lines[arguments[1] - 1].ref;
+
+    if (!strcmp(operation, UNION))
+    {
+        PrintElements(universe, set1->ids, set1->numberOfItems);
+        for (int i = 0; i < group->onlyCount[1 - k]; i++)
+            PrintElement(universe, group->only[1 - k][i]);
+    }
+    else if (!strcmp(operation, INTERSECT))
+        PrintElements(universe, group->common[k], group->commonCount);
+    else if (!strcmp(operation, MINUS))
+        PrintElements(universe, group->only[k], group->onlyCount[k]);
+    else if (!strcmp(operation, SUBSETEQ))
+        fprintf(output, !group->onlyCount[k] ? _TRUE : _FALSE);
+    else if (!strcmp(operation, SUBSET))
+        fprintf(output, !group->onlyCount[k] && set1->numberOfItems != set2->numberOfItems ? _TRUE : _FALSE);
+    else if (!strcmp(operation, CARD_INTERSECT))
+        fprintf(output, "%d", group->commonCount);
+    else if (!strcmp(operation, CARD_UNION))
+        fprintf(output, "%d", set1->numberOfItems + group->onlyCount[1 - k]);
+    else if (!strcmp(operation, CARD_MINUS))
+        fprintf(output, "%d", group->onlyCount[k]);
+    else
+        fprintf(output, "%g", __jaccard(group->commonCount, set1->numberOfItems, set2->numberOfItems));
+}
+
+// frees results of group
+static void __freeGroup(group_t *group)
+{
+    for (int k = 0; k < PAIR; k++)
+    {
+        free(group->common[k]);
+        free(group->only[k]);
+    }
+}
+
+// returns true if str is a range of lines "A-B" (or "A..B" with separator "..")
+static bool __range(char *str, const char *separator, int *first, int *last)
+{
+    char *end;
+    size_t length = strlen(separator);
+
+    if (str[0] < '0' || str[0] > '9')
+        return false;
+    *first = strtol(str, &end, 10);
+    if (strncmp(end, separator, length) || end[length] < '0' || end[length] > '9')
+        return false;
+    *last = strtol(end + length, &end, 10);
+    return *end == '\0';
+}
+
+// returns remembered result of command or NULL
+static entry_t *CacheFind(cache_t *cache, uint64_t key)
+{
+    if (!cache->capacity)
+        return NULL;
+    for (int slot = key & (cache->capacity - 1); cache->entries[slot].key; slot = (slot + 1) & (cache->capacity - 1))
+        if (cache->entries[slot].key == key)
+            return &cache->entries[slot];
+    return NULL;
+}
+
+// remembers result of command used by this run, result belongs to cache if there wasn't an error
+static int CacheAdd(cache_t *cache, uint64_t key, char *result)
+{
+    entry_t *entry;
+
+    // keeps cache at most half full
+    if (2 * (cache->count + 1) > cache->capacity)
+    {
+        cache_t larger = {NULL, cache->capacity ? 2 * cache->capacity : 64, 0};
+
+        if ((larger.entries = calloc(larger.capacity, sizeof(entry_t))) == NULL)
+            return MEMORY_ERR;
+        for (int i = 0; i < cache->capacity; i++)
+            if (cache->entries[i].key)
+            {
+                int slot = cache->entries[i].key & (larger.capacity - 1);
+                while (larger.entries[slot].key)
+                    slot = (slot + 1) & (larger.capacity - 1);
+                larger.entries[slot] = cache->entries[i];
+                larger.count++;
+            }
+        free(cache->entries);
+        *cache = larger;
+    }
+
+    if ((entry = CacheFind(cache, key)) != NULL) // the same command is in file more times
+    {
+        free(entry->result);
+        entry->result = result;
+        entry->used = true;
+        return EXIT_SUCCESS;
+    }
+    int slot = key & (cache->capacity - 1);
+    while (cache->entries[slot].key)
+        slot = (slot + 1) & (cache->capacity - 1);
+    cache->entries[slot].key = key;
+    cache->entries[slot].result = result;
+    cache->entries[slot].used = true;
+    cache->count++;
+    return EXIT_SUCCESS;
+}
+
+#ifndef SETCAL_LIBRARY
+// frees remembered results
+static void FreeCache(cache_t *cache)
+{
+    for (int i = 0; i < cache->capacity; i++)
+        free(cache->entries[i].result);
+    free(cache->entries);
+}
+#endif
+
+// returns true if set is empty
+static void SetEmpty(set_t *set)
+{
+    fprintf(output, (set->numberOfItems) ? _FALSE : _TRUE);
+}
+
+// returns number of elements from set
+static void SetCard(set_t *set)
+{
+    fprintf(output, "%d", set->numberOfItems);
+}
+
+// prints set given by universe indexes
+static void PrintElements(set_t *universe, int *ids, int count)
+{
+    PrintTag(SET);
+    for (int i = 0; i < count; i++)
+        PrintElement(universe, ids[i]);
+}
+
+// starts result of type (set, relation, list), frames keep the type instead of printing it
+static void PrintTag(char type)
+{
+    if (outputMode == OUTPUT_BINARY && frame.stream != NULL)
+        frame.type = type;
+    else
+        fputc(type == SETCAL_FRAME_LIST ? SET : type, output);
+}
+
+// prints element as its name or universe index (--output=ids), text of frames marks indexes by '#' to tell them from numbers
+static void PrintName(set_t *universe, int id)
+{
+    if (outputMode == OUTPUT_TEXT)
+        fputs(universe->items[id], output);
+    else
+        fprintf(output, outputMode == OUTPUT_BINARY ? "#%d" : "%d", id);
+}
+
+// prints element of result, elements of set, list and relation frames are collected until the frame is written
+static void PrintElement(set_t *universe, int id)
+{
+    if (outputMode == OUTPUT_BINARY && frame.stream != NULL && (frame.type == SETCAL_FRAME_SET || frame.type == SETCAL_FRAME_LIST || frame.type == SETCAL_FRAME_RELATION))
+    {
+        void *error; // error pointer
+        if (frame.count == frame.capacity)
+        {
+            if (reallocate(error, frame.ids, (2 * frame.capacity + 16) * sizeof(int)))
+            {
+                frame.type = SETCAL_FRAME_ERROR; // frame is replaced by error
+                return;
+            }
+            frame.ids = error;
+            frame.capacity = 2 * frame.capacity + 16;
+        }
+        frame.ids[frame.count++] = id;
+        return;
+    }
+    fputc(' ', output);
+    PrintName(universe, id);
+}
+
+// prints pair of relation
+static void PrintPair(set_t *universe, int left, int right)
+{
+    if (outputMode == OUTPUT_BINARY && frame.stream != NULL && frame.type == SETCAL_FRAME_RELATION)
+    {
+        PrintElement(universe, left);
+        PrintElement(universe, right);
+        return;
+    }
+    fputs(" (", output);
+    PrintName(universe, left);
+    PrintElement(universe, right);
+    fputc(')', output);
+}
+
+// prints universe, it always has names of elements so that indexes can be read back
+static void PrintUniverse(set_t *universe)
+{
+    if (outputMode == OUTPUT_BINARY && frame.stream != NULL)
+    {
+        frame.type = SETCAL_FRAME_UNIVERSE;
+        for (int i = 0; i < universe->numberOfItems; i++)
+        {
+            __putVarint(output, strlen(universe->items[i]));
+            fputs(universe->items[i], output);
+        }
+        return;
+    }
+    fputc(UNIVERSE, output);
+    for (int i = 0; i < universe->numberOfItems; i++)
+        fprintf(output, " %s", universe->items[i]);
+}
+
+// ends line of output
+static void NewLine(void)
+{
+    if (outputMode == OUTPUT_BINARY && frame.stream != NULL)
+        FrameEnd();
+    else
+        fputc('\n', output);
+}
+
+// starts printing lines as frames into stream, returns error code
+static int FrameOpen(FILE *stream)
+{
+    frame.stream = stream;
+    frame.type = SETCAL_FRAME_TEXT;
+    frame.count = 0;
+    if ((output = open_memstream(&frame.text, &frame.size)) == NULL)
+    {
+        output = stream;
+        frame.stream = NULL;
+        return MEMORY_ERR;
+    }
+    return 0;
+}
+
+// writes varint
+static void __putVarint(FILE *fp, unsigned value)
+{
+    for (; value >= 0x80; value >>= 7)
+        fputc((value & 0x7f) | 0x80, fp);
+    fputc(value, fp);
+}
+
+// writes frame of type with payload
+static void PrintFrame(char type, const uint8_t *payload, int length)
+{
+    __putVarint(frame.stream, length + 1);
+    fputc(type, frame.stream);
+    fwrite(payload, 1, length, frame.stream);
+}
+
+/*
+ * Writes the current line as frame and starts the next one. Set is written as
+ * gaps between its sorted ids, or as bitset of ids if it's smaller (dense sets).
+ */
+static void FrameEnd(void)
+{
+    FILE *stream = frame.stream;
+    int length = 0;
+
+    fclose(output);
+    output = stream;
+
+    if (frame.type == SETCAL_FRAME_SET)
+    {
+        int bitset = 0; // bytes of bitset
+
+        qsort(frame.ids, frame.count, sizeof(int), __compareIds);
+        for (int i = 0; i < frame.count; i++)
+            length += __varintLength(frame.ids[i] - (i ? frame.ids[i - 1] : 0));
+        if (frame.count)
+            bitset = frame.ids[frame.count - 1] / 8 + 1;
+
+        __putVarint(stream, 2 + (frame.count && bitset < length ? bitset : length));
+        fputc(SETCAL_FRAME_SET, stream);
+        if (frame.count && bitset < length)
+        {
+            uint8_t byte = 0;
+            fputc(SETCAL_FRAME_BITSET, stream);
+            for (int i = 0, position = 0; i < frame.count; i++)
+            {
+                for (; position < frame.ids[i] / 8; position++, byte = 0)
+                    fputc(byte, stream);
+                byte |= 1 << (frame.ids[i] % 8);
+            }
+            fputc(byte, stream);
+        }
+        else
+        {
+            fputc(SETCAL_FRAME_GAPS, stream);
+            for (int i = 0; i < frame.count; i++)
+                __putVarint(stream, frame.ids[i] - (i ? frame.ids[i - 1] : 0));
+        }
+    }
+    else if (frame.type == SETCAL_FRAME_LIST || frame.type == SETCAL_FRAME_RELATION)
+    {
+        for (int i = 0; i < frame.count; i++)
+            length += __varintLength(frame.ids[i]);
+        __putVarint(stream, length + 1);
+        fputc(frame.type, stream);
+        for (int i = 0; i < frame.count; i++)
+            __putVarint(stream, frame.ids[i]);
+    }
+    else if (frame.type == SETCAL_FRAME_ERROR)
+        PrintFrame(SETCAL_FRAME_ERROR, (const uint8_t *)ErrorMessage(MEMORY_ERR), strlen(ErrorMessage(MEMORY_ERR)));
+    else
+        PrintFrame(frame.type, (const uint8_t *)frame.text, frame.size);
+
+    free(frame.text);
+    frame.text = NULL;
+    if (FrameOpen(stream)) // without memory the rest of lines is printed as text
+        outputMode = OUTPUT_IDS;
+}
+
+#ifndef SETCAL_LIBRARY
+// writes the last line as frame and stops printing frames
+static void FrameClose(void)
+{
+    FILE *stream = frame.stream;
+
+    if (stream == NULL)
+        return;
+    FrameEnd();
+    fclose(output);
+    free(frame.text);
+    free(frame.ids);
+    frame.text = NULL;
+    frame.ids = NULL;
+    frame.capacity = 0;
+    frame.stream = NULL;
+    output = stream;
+}
+#endif
+
+// returns true if set contains element
+static bool __contains(set_t *set, int id)
+{
+    if (set->numberOfItems > SMALL_SET && __roaring(set) != NULL)
+    {
+        container_t *container = __container(set->roaring, id >> 16);
+        return container != NULL && __containerContains(container, id & 0xffff);
+    }
+    for (int i = 0; i < set->numberOfItems; i++)
+        if (set->ids[i] == id)
+            return true;
+    return false;
+}
+
+/*
+ * Returns compressed bitmap of set or NULL without memory.
+ * Universe indexes are split into chunks of 2^16 by their upper bits. Each
+ * chunk is stored in the smallest of the containers: sorted array of lower
+ * bits, bitmap of the whole chunk or runs of consecutive indexes.
+ */
+static roaring_t *__roaring(set_t *set)
+{
+    roaring_t *roaring;
+    int *ids;
+
+    if (set->roaring != NULL)
+        return set->roaring;
+    if ((ids = __sorted(set)) == NULL || (roaring = calloc(1, sizeof(roaring_t))) == NULL)
+        return NULL;
+    if ((roaring->containers = calloc(set->numberOfItems ? set->numberOfItems : 1, sizeof(container_t))) == NULL)
+    {
+        free(roaring);
+        return NULL;
+    }
+
+    for (int begin = 0, end; begin < set->numberOfItems; begin = end)
+    {
+        container_t *container = &roaring->containers[roaring->count++];
+        int runs = 1;
+
+        for (end = begin + 1; end < set->numberOfItems && ids[end] >> 16 == ids[begin] >> 16; end++)
+            runs += ids[end] != ids[end - 1] + 1;
+        container->key = ids[begin] >> 16;
+        container->cardinality = end - begin;
+
+        if (2 * runs < container->cardinality && 4 * runs < CONTAINER_SIZE / 8)
+        {
+            container->type = RUN_CONTAINER;
+            if ((container->values = malloc(2 * runs * sizeof(uint16_t))) == NULL)
+                break;
+            for (int i = begin; i < end; i++)
+                if (i == begin || ids[i] != ids[i - 1] + 1)
+                {
+                    container->values[2 * container->count] = ids[i] & 0xffff;
+                    container->values[2 * container->count++ + 1] = 0;
+                }
+                else
+                    container->values[2 * container->count - 1]++;
+        }
+        else if (container->cardinality <= ARRAY_LIMIT)
+        {
+            container->type = ARRAY_CONTAINER;
+            if ((container->values = malloc(container->cardinality * sizeof(uint16_t))) == NULL)
+                break;
+            for (int i = begin; i < end; i++)
+                container->values[container->count++] = ids[i] & 0xffff;
+        }
+        else
+        {
+            container->type = BITMAP_CONTAINER;
+            if ((container->bits = calloc(CONTAINER_SIZE / 64, sizeof(uint64_t))) == NULL)
+                break;
+            for (int i = begin; i < end; i++)
+                container->bits[(ids[i] & 0xffff) / 64] |= (uint64_t)1 << (ids[i] % 64);
+        }
+    }
+
+    // containers are complete only if there was memory for all of them
+    if (roaring->count && roaring->containers[roaring->count - 1].values == NULL && roaring->containers[roaring->count - 1].bits == NULL)
+    {
+        __freeRoaring(roaring);
+        return NULL;
+    }
+    return set->roaring = roaring;
+}
+
+// frees compressed bitmap
+static void __freeRoaring(roaring_t *roaring)
+{
+    if (roaring == NULL)
+        return;
+    for (int i = 0; i < roaring->count; i++)
+    {
+        free(roaring->containers[i].values);
+        free(roaring->containers[i].bits);
+    }
+    free(roaring->containers);
+    free(roaring);
+}
+
+// returns container of chunk or NULL if set has no element in it
+static container_t *__container(roaring_t *roaring, int key)
+{
+    int low = 0, high = roaring->count - 1;
+    while (low <= high)
+    {
+        int middle = (low + high) / 2;
+        if (roaring->containers[middle].key == key)
+            return &roaring->containers[middle];
+        if (roaring->containers[middle].key < key)
+            low = middle + 1;
+        else
+            high = middle - 1;
+    }
+    return NULL;
+}
+
+// returns true if container contains element with lower bits low
+static bool __containerContains(container_t *container, uint16_t low)
+{
+    int first = 0, last = container->count - 1;
+
+    if (container->type == BITMAP_CONTAINER)
+        return container->bits[low / 64] >> (low % 64) & 1;
+    if (container->type == ARRAY_CONTAINER)
+    {
+        while (first <= last)
+        {
+            int middle = (first + last) / 2;
+            if (container->values[middle] == low)
+                return true;
+            if (container->values[middle] < low)
+                first = middle + 1;
+            else
+                last = middle - 1;
+        }
+        return false;
+    }
+    // the last run which starts at low or before it
+    while (first < last)
+    {
+        int middle = (first + last + 1) / 2;
+        if (container->values[2 * middle] <= low)
+            first = middle;
+        else
+            last = middle - 1;
+    }
+    return container->values[2 * first] <= low && low - container->values[2 * first] <= container->values[2 * first + 1];
+}
+
+// writes container as bitmap of its chunk into bits
+static void __containerBits(container_t *container, uint64_t *bits)
+{
+    if (container->type == BITMAP_CONTAINER)
+    {
+        memcpy(bits, container->bits, CONTAINER_SIZE / 8);
+        return;
+    }
+    memset(bits, 0, CONTAINER_SIZE / 8);
+    if (container->type == ARRAY_CONTAINER)
+        for (int i = 0; i < container->count; i++)
+            bits[container->values[i] / 64] |= (uint64_t)1 << (container->values[i] % 64);
+    else
+        for (int i = 0; i < container->count; i++)
+            for (int low = container->values[2 * i]; low <= container->values[2 * i] + container->values[2 * i + 1]; low++)
+                bits[low / 64] |= (uint64_t)1 << (low % 64);
+}
+
+// returns number of elements in both containers of the same chunk
+static int __containerCommon(container_t *container1, container_t *container2)
+{
+    int count = 0;
+
+    if (container2->type == ARRAY_CONTAINER && container1->type != ARRAY_CONTAINER)
+        return __containerCommon(container2, container1);
+    if (container1->type == ARRAY_CONTAINER) // array is probed against the other container
+    {
+        for (int i = 0; i < container1->count; i++)
+            count += __containerContains(container2, container1->values[i]);
+        return count;
+    }
+    if (container1->type == RUN_CONTAINER && container2->type == RUN_CONTAINER) // overlaps of runs
+    {
+        for (int i = 0, j = 0; i < container1->count && j < container2->count;)
+        {
+            int end1 = container1->values[2 * i] + container1->values[2 * i + 1];
+            int end2 = container2->values[2 * j] + container2->values[2 * j + 1];
+            int start = container1->values[2 * i] > container2->values[2 * j] ? container1->values[2 * i] : container2->values[2 * j];
+            int end = end1 < end2 ? end1 : end2;
+
+            if (start <= end)
+                count += end - start + 1;
+            if (end1 < end2)
+                i++;
+            else
+                j++;
+        }
+        return count;
+    }
+
+    uint64_t bits1[CONTAINER_SIZE / 64], bits2[CONTAINER_SIZE / 64];
+    __containerBits(container1, bits1);
+    __containerBits(container2, bits2);
+    return __commonBits(bits1, bits2, CONTAINER_SIZE / 64);
+}
+
+// returns number of elements in both compressed bitmaps
+static int __roaringCommon(roaring_t *roaring1, roaring_t *roaring2)
+{
+    int count = 0;
+    for (int i = 0, j = 0; i < roaring1->count && j < roaring2->count;)
+    {
+        if (roaring1->containers[i].key < roaring2->containers[j].key)
+            i++;
+        else if (roaring1->containers[i].key > roaring2->containers[j].key)
+            j++;
+        else
+            count += __containerCommon(&roaring1->containers[i++], &roaring2->containers[j++]);
+    }
+    return count;
+}
+
+// returns true if every element of roaring1 is in roaring2
+static bool __roaringSubseteq(roaring_t *roaring1, roaring_t *roaring2)
+{
+    for (int i = 0, j = 0; i < roaring1->count; i++)
+    {
+        while (j < roaring2->count && roaring2->containers[j].key < roaring1->containers[i].key)
+            j++;
+        if (j == roaring2->count || roaring2->containers[j].key != roaring1->containers[i].key ||
+            roaring1->containers[i].cardinality > roaring2->containers[j].cardinality ||
+            __containerCommon(&roaring1->containers[i], &roaring2->containers[j]) != roaring1->containers[i].cardinality)
+            return false;
+    }
+    return true;
+}
+
+// writes indexes 0..size - 1 which aren't in compressed bitmap into ids in ascending order
+static int __roaringComplement(roaring_t *roaring, int size, int *ids)
+{
+    int count = 0;
+    int next = 0; // the first container which wasn't passed
+
+    for (int chunk = 0; chunk <= (size - 1) >> 16 && size; chunk++)
+    {
+        int base = chunk << 16;
+        int limit = size - base < CONTAINER_SIZE ? size - base : CONTAINER_SIZE;
+        container_t *container = NULL;
+        int low = 0;
+
+        while (next < roaring->count && roaring->containers[next].key < chunk)
+            next++;
+        if (next < roaring->count && roaring->containers[next].key == chunk)
+            container = &roaring->containers[next];
+
+        if (container == NULL)
+            for (; low < limit; low++)
+                ids[count++] = base + low;
+        else if (container->type == BITMAP_CONTAINER)
+        {
+            for (; low < limit; low++)
+                if (!(container->bits[low / 64] >> (low % 64) & 1))
+                    ids[count++] = base + low;
+        }
+        else // gaps between values or runs
+        {
+            int step = container->type == RUN_CONTAINER ? 2 : 1;
+            for (int i = 0; i < container->count; i++)
+            {
+                int start = container->values[step * i];
+                int end = step == 2 ? start + container->values[2 * i + 1] : start;
+                for (; low < start && low < limit; low++)
+                    ids[count++] = base + low;
+                low = end + 1;
+            }
+            for (; low < limit; low++)
+                ids[count++] = base + low;
+        }
+    }
+    return count;
+}
+
+// component for Minus, writes elements of set1 which aren't in set2 into ids
+static int __minus(set_t *set1, set_t *set2, int *ids)
+{
+    int count = 0;
+    for (int i = 0; i < set1->numberOfItems; i++)
+        if (!__contains(set2, set1->ids[i]))
+            ids[count++] = set1->ids[i];
+    return count;
+}
+
+// component for Complement, writes elements of universe which aren't in set into ids (universe indexes are in order of universe)
+static int __complement(set_t *set, set_t *universe, int *ids)
+{
+    if (set->numberOfItems > SMALL_SET && __roaring(set) != NULL)
+        return __roaringComplement(set->roaring, universe->numberOfItems, ids);
+    return __minus(universe, set, ids);
+}
+
+// component for Union, writes elements of set1 and then elements of set2 which aren't in set1 into ids
+static int __union(set_t *set1, set_t *set2, int *ids)
+{
+    memcpy(ids, set1->ids, set1->numberOfItems * sizeof(int));
+    return set1->numberOfItems + __minus(set2, set1, ids + set1->numberOfItems);
+}
+
+// component for Intersect, writes elements of set1 which are in set2 into ids
+static int __intersect(set_t *set1, set_t *set2, int *ids)
+{
+    int count = 0;
+    for (int i = 0; i < set1->numberOfItems; i++)
+        if (__contains(set2, set1->ids[i]))
+            ids[count++] = set1->ids[i];
+    return count;
+}
+
+// component for Subseteq
+static bool __subseteq(set_t *set1, set_t *set2)
+{
+    if (set1->numberOfItems == 0)
+        return true;
+    if (set2->numberOfItems == 0 || set1->numberOfItems > set2->numberOfItems)
+        return false;
+    if (set1->numberOfItems > SMALL_SET && __roaring(set1) != NULL && __roaring(set2) != NULL)
+        return __roaringSubseteq(set1->roaring, set2->roaring);
+    for (int i = 0; i < set1->numberOfItems; i++)
+        if (!__contains(set2, set1->ids[i]))
+            return false;
+    return true;
+}
+
+// component for Subset
+static bool __subset(set_t *set1, set_t *set2)
+{
+    if (set2->numberOfItems == 0)
+        return false;
+    return set1->numberOfItems < set2->numberOfItems && __subseteq(set1, set2);
+}
+
+// component for Equals, sets with different fingerprints differ, the same fingerprint is confirmed by sorted ids
+static bool __equals(set_t *set1, set_t *set2)
+{
+    int *sorted1, *sorted2;
+
+    if (set1 == set2)
+        return true;
+    if (set2->numberOfItems != set1->numberOfItems || memcmp(set1->digest, set2->digest, sizeof(set1->digest)))
+        return false;
+    if ((sorted1 = __sorted(set1)) == NULL || (sorted2 = __sorted(set2)) == NULL)
+        return __subseteq(set1, set2); // without memory for sorted ids, sets of the same size are equal if one is subset of the other
+    return !memcmp(sorted1, sorted2, set1->numberOfItems * sizeof(int));
+}
+
+// Complement
+static void SetComplement(set_t *set, set_t *universe, int *errorCode)
+{
+    int *ids;
+    if (allocate(ids, (universe->numberOfItems + 1) * sizeof(int)))
+    {
+        *errorCode = MEMORY_ERR;
+        return;
+    }
+    PrintElements(universe, ids, __complement(set, universe, ids));
+    free(ids);
+}
+
+// Union
+static void SetUnion(set_t *set1, set_t *set2, set_t *universe, int *errorCode)
+{
+    int *ids;
+    if (allocate(ids, (set1->numberOfItems + set2->numberOfItems + 1) * sizeof(int)))
+    {
+        *errorCode = MEMORY_ERR;
+        return;
+    }
+    PrintElements(universe, ids, __union(set1, set2, ids));
+    free(ids);
+}
+
+// Intersect
+static void SetIntersect(set_t *set1, set_t *set2, set_t *universe, int *errorCode)
+{
+    int *ids;
+    if (allocate(ids, (set1->numberOfItems + 1) * sizeof(int)))
+    {
+        *errorCode = MEMORY_ERR;
+        return;
+    }
+    PrintElements(universe, ids, __intersect(set1, set2, ids));
+    free(ids);
+}
+
+// Minus
+static void SetMinus(set_t *set1, set_t *set2, set_t *universe, int *errorCode)
+{
+    int *ids;
+    if (allocate(ids, (set1->numberOfItems + 1) * sizeof(int)))
+    {
+        *errorCode = MEMORY_ERR;
+        return;
+    }
+    PrintElements(universe, ids, __minus(set1, set2, ids));
+    free(ids);
+}
+
+// Subseteq
+static void SetSubseteq(set_t *set1, set_t *set2)
+{
+    fprintf(output, __subseteq(set1, set2) ? _TRUE : _FALSE);
+}
+
+// Subset
+static void SetSubset(set_t *set1, set_t *set2)
+{
+    fprintf(output, __subset(set1, set2) ? _TRUE : _FALSE);
+}
+
+// Equals
+static void SetEquals(set_t *set1, set_t *set2)
+{
+    fprintf(output, __equals(set1, set2) ? _TRUE : _FALSE);
+}
+
+// Member
+static void SetMember(set_t *set, set_t *universe, char *element, int *errorCode)
+{
+    int id = __indexOf(universe, element);
+    if (id < 0)
+    {
+        *errorCode = ARGS_ERR;
+        return;
+    }
+    fprintf(output, __contains(set, id) ? _TRUE : _FALSE);
+}
+
+// Sets-containing, prints line numbers of sets which contain element
+static void SetsContaining(line_t *lines, int numberOfLines, char *element, int *errorCode)
+{
+    int id = __indexOf((set_t *)lines[0].ref, element);
+    postings_t *postings = lines[0].postings;
+    unsigned line = 0;
+
+    if (id < 0)
+    {
+        *errorCode = ARGS_ERR;
+        return;
+    }
+    if (postings == NULL && (postings = lines[0].postings = __postings(lines, numberOfLines, errorCode)) == NULL)
+        return;
+
+    for (int k = postings->start[id]; k < postings->start[id + 1];)
+    {
+        unsigned gap = 0;
+        for (int shift = 0;; shift += 7)
+        {
+            gap |= (unsigned)(postings->bytes[k] & 0x7f) << shift;
+            if (!(postings->bytes[k++] & 0x80))
+                break;
+        }
+        fprintf(output, line ? " %u" : "%u", line + gap);
+        line += gap;
+    }
+}
+
+// returns number of bytes of value stored as varint (7 bits in each byte)
+static int __varintLength(unsigned value)
+{
+    int length = 1;
+    while (value >>= 7)
+        length++;
+    return length;
+}
+
+/*
+ * Returns inverted index of sets of lines or NULL without memory. Lines of sets
+ * which contain an element are stored in ascending order as gaps from the
+ * previous line, 7 bits in each byte, so postings take about a byte per element
+ * of each set. Index is read from ids of sets, a shared set is listed on every
+ * line which declares it.
+ */
+static postings_t *__postings(line_t *lines, int numberOfLines, int *errorCode)
+{
+    int n = ((set_t *)lines[0].ref)->numberOfItems;
+    postings_t *postings = malloc(sizeof(postings_t));
+    int *last = calloc(n + 1, sizeof(int)); // the last line added to postings of element
+    int *next = malloc((n + 1) * sizeof(int)); // position where the next gap of element is written
+
+    if (postings == NULL || last == NULL || next == NULL || (postings->start = calloc(n + 1, sizeof(int))) == NULL)
+    {
+        free(postings);
+        free(last);
+        free(next);
+        *errorCode = MEMORY_ERR;
+        return NULL;
+    }
+
+    // sizes of postings
+    for (int i = 1; i < numberOfLines; i++)
+        if (lines[i].type == SET)
+        {
+            set_t *set = (set_t *)lines[i].ref;
+            for (int j = 0; j < set->numberOfItems; j++)
+            {
+                postings->start[set->ids[j] + 1] += __varintLength(i + 1 - last[set->ids[j]]);
+                last[set->ids[j]] = i + 1;
+            }
+        }
+    for (int u = 0; u < n; u++)
+    {
+        postings->start[u + 1] += postings->start[u];
+        next[u] = postings->start[u];
+        last[u] = 0;
+    }
+
+    if ((postings->bytes = malloc(postings->start[n] + 1)) == NULL)
+    {
+        __freePostings(postings);
+        postings = NULL;
+        *errorCode = MEMORY_ERR;
+    }
+    else
+        for (int i = 1; i < numberOfLines; i++)
+            if (lines[i].type == SET)
+            {
+                set_t *set = (set_t *)lines[i].ref;
+                for (int j = 0; j < set->numberOfItems; j++)
+                {
+                    int id = set->ids[j];
+                    unsigned gap = i + 1 - last[id];
+
+                    for (; gap >= 0x80; gap >>= 7)
+                        postings->bytes[next[id]++] = (gap & 0x7f) | 0x80;
+                    postings->bytes[next[id]++] = gap;
+                    last[id] = i + 1;
+                }
+            }
+
+    free(last);
+    free(next);
+    return postings;
+}
+
+// frees inverted index of sets
+static void __freePostings(postings_t *postings)
+{
+    if (postings == NULL)
+        return;
+    free(postings->start);
+    free(postings->bytes);
+    free(postings);
+}
+
+// returns new set with ids (taken over by set), negated set stands for universe without them, NULL without memory
+static set_t *__symbolic(int *ids, int count, bool negated, int *errorCode)
+{
+    set_t *set = calloc(1, sizeof(set_t));
+    if (set == NULL)
+    {
+        free(ids);
+        *errorCode = MEMORY_ERR;
+        return NULL;
+    }
+    set->ids = ids;
+    set->numberOfItems = count;
+    set->references = 1;
+    set->negated = negated;
+    return set;
+}
+
+// returns copy of set, or of its complement if complement (it keeps the same elements and only its flag is flipped)
+static set_t *__negation(set_t *set, bool complement, int *errorCode)
+{
+    int *ids;
+    if (allocate(ids, (set->numberOfItems + 1) * sizeof(int)))
+    {
+        *errorCode = MEMORY_ERR;
+        return NULL;
+    }
+    memcpy(ids, set->ids, set->numberOfItems * sizeof(int));
+    return __symbolic(ids, set->numberOfItems, set->negated != complement, errorCode);
+}
+
+/*
+ * Returns intersection of set1 (or its complement if complement1) and set2 (or its
+ * complement), sets can be negated. Only stored elements are visited (De Morgan):
+ * A & ~B = A \ B, ~A & B = B \ A, ~A & ~B = ~(A | B), so complements of small sets
+ * stay small. Union and minus are intersections of complements: A | B = ~(~A & ~B)
+ * and A \ B = A & ~B.
+ */
+static set_t *__symbolicIntersect(set_t *set1, bool complement1, set_t *set2, bool complement2, int *errorCode)
+{
+    bool negated1 = set1->negated != complement1;
+    bool negated2 = set2->negated != complement2;
+    int *ids;
+    int count;
+
+    if (allocate(ids, (set1->numberOfItems + set2->numberOfItems + 1) * sizeof(int)))
+    {
+        *errorCode = MEMORY_ERR;
+        return NULL;
+    }
+    if (!negated1 && !negated2)
+        count = __intersect(set1, set2, ids);
+    else if (!negated1)
+        count = __minus(set1, set2, ids);
+    else if (!negated2)
+        count = __minus(set2, set1, ids);
+    else
+        count = __union(set1, set2, ids);
+    return __symbolic(ids, count, negated1 && negated2, errorCode);
+}
+
+// returns number of elements of set which can be negated
+static int __symbolicCard(set_t *set, set_t *universe)
+{
+    return set->negated ? universe->numberOfItems - set->numberOfItems : set->numberOfItems;
+}
+
+/*
+ * Executes set command whose arguments are complements of sets (~A). Results are
+ * computed on stored elements of sets, a negated result is enumerated over
+ * universe only when it's printed.
+ */
+static void SetSymbolic(char *operation, line_t *lines, int *arguments, int count, unsigned negations, int *errorCode)
+{
+    set_t *universe = (set_t *)lines[0].ref;
+    set_t *set1 = (set_t *)lines[arguments[0] - 1].ref;
+    set_t *set2 = (set_t *)lines[arguments[count - 1] - 1].ref;
+    set_t *result = NULL; // result which is a set
+    bool complement1 = negations & 1;
+    bool complement2 = negations >> 1 & 1;
+
+    if (count == 1 && !strcmp(operation, EMPTY))
+        fprintf(output, (complement1 ? set1->numberOfItems == universe->numberOfItems : !set1->numberOfItems) ? _TRUE : _FALSE);
+    else if (count == 1 && !strcmp(operation, CARD))
+        fprintf(output, "%d", complement1 ? universe->numberOfItems - set1->numberOfItems : set1->numberOfItems);
+    else if (count == 1 && !strcmp(operation, COMPLEMENT))
+        result = __negation(set1, !complement1, errorCode);
+    else if (count == 2 && !strcmp(operation, INTERSECT))
+        result = __symbolicIntersect(set1, complement1, set2, complement2, errorCode);
+    else if (count == 2 && !strcmp(operation, MINUS))
+        result = __symbolicIntersect(set1, complement1, set2, !complement2, errorCode);
+    else if (count == 2 && !strcmp(operation, UNION))
+    {
+        if ((result = __symbolicIntersect(set1, !complement1, set2, !complement2, errorCode)) != NULL)
+            result->negated = !result->negated;
+    }
+    else if (count == 2 && (!strcmp(operation, SUBSETEQ) || !strcmp(operation, SUBSET) || !strcmp(operation, EQUALS)))
+    {
+        // A is subset of B if A \ B is empty, it's proper if B \ A isn't empty
+        set_t *difference1 = __symbolicIntersect(set1, complement1, set2, !complement2, errorCode);
+        set_t *difference2 = __symbolicIntersect(set2, complement2, set1, !complement1, errorCode);
+
+        if (!*errorCode)
+        {
+            bool subseteq = !__symbolicCard(difference1, universe);
+            bool supseteq = !__symbolicCard(difference2, universe);
+            bool fl = !strcmp(operation, SUBSETEQ) ? subseteq : !strcmp(operation, SUBSET) ? subseteq && !supseteq : subseteq && supseteq;
+            fprintf(output, fl ? _TRUE : _FALSE);
+        }
+        if (difference1 != NULL)
+            FreeSet(difference1);
+        if (difference2 != NULL)
+            FreeSet(difference2);
+    }
+    else
+        *errorCode = ARGS_ERR;
+
+    if (result == NULL)
+        return;
+    if (!result->negated)
+        PrintElements(universe, result->ids, result->numberOfItems);
+    else
+    {
+        int *ids;
+        if (allocate(ids, (universe->numberOfItems + 1) * sizeof(int)))
+            *errorCode = MEMORY_ERR;
+        else
+        {
+            PrintElements(universe, ids, __complement(result, universe, ids));
+            free(ids);
+        }
+    }
+    FreeSet(result);
+}
+
+// returns number of threads for work split between processors
+static int __threads(void)
+{
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return online < 1 ? 1 : online > MAX_THREADS ? MAX_THREADS : (int)online;
+}
+
+// returns number of threads for count items of work of cost operations, a thread for each PARALLEL_COST of them
+static int __parts(int count, long cost)
+{
+    int parts = profile != NULL ? 1 : __threads(); // counters of --perf count only the calling thread
+
+    if (parts > cost / PARALLEL_COST)
+        parts = cost / PARALLEL_COST;
+    if (parts > count)
+        parts = count;
+    return parts < 1 ? 1 : parts;
+}
+
+/*
+ * Splits items 0..count - 1 into consecutive parts and calls work for each of
+ * them in its own thread, the calling thread computes the first part. A part
+ * whose thread can't be started is computed by the calling thread too.
+ */
+static void __parallel(void *(*work)(void *), void *shared, int count, int parts)
+{
+    part_t part[MAX_THREADS];
+    pthread_t threads[MAX_THREADS];
+    bool started[MAX_THREADS];
+
+    for (int i = 0; i < parts; i++)
+    {
+        part[i].shared = shared;
+        part[i].index = i;
+        part[i].first = (long)count * i / parts;
+        part[i].last = (long)count * (i + 1) / parts;
+    }
+    for (int i = 1; i < parts; i++)
+        started[i] = !pthread_create(&threads[i], NULL, work, &part[i]);
+    work(&part[0]);
+    for (int i = 1; i < parts; i++)
+        if (started[i])
+            pthread_join(threads[i], NULL);
+        else
+            work(&part[i]);
+}
+
+// returns number of ones in word
+static int __popcount(uint64_t word)
+{
+#ifdef __GNUC__
+    return __builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (word * 0x0101010101010101ULL) >> 56;
+#endif
+}
+
+// returns bitmap of set over universe or NULL without memory
+static uint64_t *__bits(set_t *set, set_t *universe)
+{
+    if (set->bits == NULL && (set->bits = calloc(universe->numberOfItems / 64 + 1, sizeof(uint64_t))) != NULL)
+        for (int i = 0; i < set->numberOfItems; i++)
+            set->bits[set->ids[i] / 64] |= (uint64_t)1 << (set->ids[i] % 64);
+    return set->bits;
+}
+
+// compares ids for qsort
+static int __compareIds(const void *a, const void *b)
+{
+    return (*(const int *)a > *(const int *)b) - (*(const int *)a < *(const int *)b);
+}
+
+// compares keys for qsort
+static int __compareKeys(const void *a, const void *b)
+{
+    return (*(const uint64_t *)a > *(const uint64_t *)b) - (*(const uint64_t *)a < *(const uint64_t *)b);
+}
+
+// returns ids of set in ascending order or NULL without memory
+static int *__sorted(set_t *set)
+{
+    if (set->sorted == NULL && !allocate(set->sorted, (set->numberOfItems + 1) * sizeof(int)))
+    {
+        memcpy(set->sorted, set->ids, set->numberOfItems * sizeof(int));
+        qsort(set->sorted, set->numberOfItems, sizeof(int), __compareIds);
+    }
+    return set->sorted;
+}
+
+// returns number of elements in both bitmaps
+static int __commonBits(uint64_t *bits1, uint64_t *bits2, int words)
+{
+    int count = 0;
+    for (int i = 0; i < words; i++)
+        count += __popcount(bits1[i] & bits2[i]);
+    return count;
+}
+
+// returns true if every element of bits1 is in bits2
+static bool __subseteqBits(uint64_t *bits1, uint64_t *bits2, int words)
+{
+    for (int i = 0; i < words; i++)
+        if (bits1[i] & ~bits2[i])
+            return false;
+    return true;
+}
+
+// returns number of elements in both sorted ids
+static int __commonSorted(int *ids1, int count1, int *ids2, int count2)
+{
+    int count = 0;
+    for (int i = 0, j = 0; i < count1 && j < count2;)
+    {
+        if (ids1[i] < ids2[j])
+            i++;
+        else if (ids1[i] > ids2[j])
+            j++;
+        else
+        {
+            count++;
+            i++;
+            j++;
+        }
+    }
+    return count;
+}
+
+// returns Jaccard similarity of two sets (two empty sets are the same)
+static double __jaccard(int common, int count1, int count2)
+{
+    return count1 + count2 - common ? (double)common / (count1 + count2 - common) : 1;
+}
+
+// returns number of elements in both sets without writing them anywhere
+static int __common(set_t *set1, set_t *set2, set_t *universe, int *errorCode)
+{
+    int words = universe->numberOfItems / 64 + 1;
+
+    // bitmaps are used if they exist or if both sets are dense, a small set never gets a bitmap over the whole universe
+    if ((set1->bits != NULL && set2->bits != NULL) ||
+        words <= (set1->numberOfItems < set2->numberOfItems ? set1->numberOfItems : set2->numberOfItems))
+    {
+        if (__bits(set1, universe) == NULL || __bits(set2, universe) == NULL)
+        {
+            *errorCode = MEMORY_ERR;
+            return 0;
+        }
+        return __commonBits(set1->bits, set2->bits, words);
+    }
+    // sparse sets (or a small and a large set) are intersected container by container
+    if (__roaring(set1) != NULL && __roaring(set2) != NULL)
+        return __roaringCommon(set1->roaring, set2->roaring);
+    if (__sorted(set1) == NULL || __sorted(set2) == NULL)
+    {
+        *errorCode = MEMORY_ERR;
+        return 0;
+    }
+    return __commonSorted(set1->sorted, set1->numberOfItems, set2->sorted, set2->numberOfItems);
+}
+
+// Card-intersect
+static void SetCardIntersect(set_t *set1, set_t *set2, set_t *universe, int *errorCode)
+{
+    int common = __common(set1, set2, universe, errorCode);
+    if (!*errorCode)
+        fprintf(output, "%d", common);
+}
+
+// Card-union
+static void SetCardUnion(set_t *set1, set_t *set2, set_t *universe, int *errorCode)
+{
+    int common = __common(set1, set2, universe, errorCode);
+    if (!*errorCode)
+        fprintf(output, "%d", set1->numberOfItems + set2->numberOfItems - common);
+}
+
+// Card-minus
+static void SetCardMinus(set_t *set1, set_t *set2, set_t *universe, int *errorCode)
+{
+    int common = __common(set1, set2, universe, errorCode);
+    if (!*errorCode)
+        fprintf(output, "%d", set1->numberOfItems - common);
+}
+
+// Jaccard
+static void SetJaccard(set_t *set1, set_t *set2, set_t *universe, int *errorCode)
+{
+    int common = __common(set1, set2, universe, errorCode);
+    if (!*errorCode)
+        fprintf(output, "%g", __jaccard(common, set1->numberOfItems, set2->numberOfItems));
+}
+
+// chooses sizes of sketches for relative error, returns error if it isn't in (0, 1)
+static int __configureSketch(double error)
+{
+    if (!(error > 0 && error < 1))
+        return ARGS_ERR;
+    // standard error of HyperLogLog is 1.04 / sqrt(registers), of MinHash 1 / sqrt(hashes)
+    for (sketchPrecision = 4; sketchPrecision < 18 && (1 << sketchPrecision) * error * error < 1.04 * 1.04; sketchPrecision++)
+        ;
+    sketchHashes = 1 / (error * error) + 1;
+    if (sketchHashes > 1 << 16)
+        sketchHashes = 1 << 16;
+    return EXIT_SUCCESS;
+}
+
+// chooses sizes of sketches for SKETCH_ERROR unless --sketch chose them
+static void __defaultSketch(void)
+{
+    if (!sketchPrecision)
+        __configureSketch(SKETCH_ERROR);
+}
+
+// returns number of leading zero bits of word
+static int __leadingZeros(uint64_t word)
+{
+#ifdef __GNUC__
+    return word ? __builtin_clzll(word) : 64;
+#else
+    int count = 0;
+    for (; count < 64 && !(word >> 63); count++)
+        word <<= 1;
+    return count;
+#endif
+}
+
+/*
+ * Builds HyperLogLog registers and MinHash signature of set.
+ * Each element is hashed once: the hash picks a register and a MinHash bucket
+ * (one permutation hashing), so the cost is linear in the set and the sketch.
+ */
+static int __sketch(set_t *set)
+{
+    int registers;
+    uint64_t hash;
+
+    if (set->registers != NULL)
+        return EXIT_SUCCESS;
+    pthread_once(&sketchDefaults, __defaultSketch);
+    registers = 1 << sketchPrecision;
+    if ((set->registers = calloc(registers, sizeof(uint8_t))) == NULL)
+        return MEMORY_ERR;
+    if (allocate(set->signature, sketchHashes * sizeof(uint64_t)))
+    {
+        free(set->registers);
+        set->registers = NULL;
+        return MEMORY_ERR;
+    }
+    for (int i = 0; i < sketchHashes; i++)
+        set->signature[i] = UINT64_MAX;
+
+    for (int i = 0; i < set->numberOfItems; i++)
+    {
+        int rank, bucket;
+
+        hash = __mix((uint64_t)set->ids[i] + 0x9e3779b97f4a7c15ULL);
+        rank = __leadingZeros(hash << sketchPrecision | (uint64_t)1 << (sketchPrecision - 1)) + 1;
+        if (set->registers[hash >> (64 - sketchPrecision)] < rank)
+            set->registers[hash >> (64 - sketchPrecision)] = rank;
+
+        hash = __mix(hash);
+        bucket = (hash >> 32) * sketchHashes >> 32;
+        if (set->signature[bucket] > hash)
+            set->signature[bucket] = hash;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+// returns natural logarithm of positive x
+static double __log(double x)
+{
+    double result = 0, term, square;
+    for (; x > 2; x /= 2)
+        result += 0.69314718055994530942;
+    for (; x < 1; x *= 2)
+        result -= 0.69314718055994530942;
+    // log(x) = 2 * (y + y^3 / 3 + y^5 / 5 + ...) for y = (x - 1) / (x + 1)
+    term = (x - 1) / (x + 1);
+    square = term * term;
+    for (int i = 1; i < 60; i += 2, term *= square)
+        result += 2 * term / i;
+    return result;
+}
+
+// returns number of elements estimated by HyperLogLog registers
+static double __estimate(uint8_t *registers)
+{
+    int count = 1 << sketchPrecision;
+    int zeros = 0;
+    double sum = 0;
+    double alpha = count == 16 ? 0.673 : count == 32 ? 0.697 : count == 64 ? 0.709 : 0.7213 / (1 + 1.079 / count);
+    double estimate;
+
+    for (int i = 0; i < count; i++)
+    {
+        sum += 1.0 / ((uint64_t)1 << registers[i]);
+        zeros += !registers[i];
+    }
+    estimate = alpha * count * count / sum;
+    if (estimate <= 2.5 * count && zeros) // small cardinalities are estimated by linear counting
+        estimate = count * __log((double)count / zeros);
+    return estimate;
+}
+
+// Approx-card
+static void SetApproxCard(set_t *set, int *errorCode)
+{
+    if ((*errorCode = __sketch(set)))
+        return;
+    fprintf(output, "%.0f", __estimate(set->registers));
+}
+
+// Approx-union-card, union of HyperLogLog sketches is their maximum
+static void SetApproxUnionCard(set_t *set1, set_t *set2, int *errorCode)
+{
+    uint8_t *registers;
+
+    if ((*errorCode = __sketch(set1)) || (*errorCode = __sketch(set2)))
+        return;
+    if (allocate(registers, (1 << sketchPrecision) * sizeof(uint8_t)))
+    {
+        *errorCode = MEMORY_ERR;
+        return;
+    }
+    for (int i = 0; i < 1 << sketchPrecision; i++)
+        registers[i] = set1->registers[i] > set2->registers[i] ? set1->registers[i] : set2->registers[i];
+    fprintf(output, "%.0f", __estimate(registers));
+    free(registers);
+}
+
+// Approx-jaccard, share of equal MinHash buckets among buckets which aren't empty in both sets
+static void SetApproxJaccard(set_t *set1, set_t *set2, int *errorCode)
+{
+    int equal = 0;
+    int filled = 0;
+
+    if ((*errorCode = __sketch(set1)) || (*errorCode = __sketch(set2)))
+        return;
+    if (!set1->numberOfItems || !set2->numberOfItems)
+    {
+        fprintf(output, "%g", __jaccard(0, set1->numberOfItems, set2->numberOfItems));
+        return;
+    }
+    for (int i = 0; i < sketchHashes; i++)
+        if (set1->signature[i] != UINT64_MAX || set2->signature[i] != UINT64_MAX)
+        {
+            equal += set1->signature[i] == set2->signature[i];
+            filled++;
+        }
+    fprintf(output, "%g", (double)equal / filled);
+}
+
+/*
+ * Matrix, compares all pairs of sets by subseteq or jaccard.
+ * Rows are computed in blocks which fit into cache, so each column is read
+ * once per block instead of once per row. Sets are compared as bitmaps over
+ * universe, unless they are so sparse that merging sorted ids is cheaper.
+ */
+static void SetMatrix(line_t *lines, int numberOfLines, int *arguments, int count, char *operation, char *layout, int *errorCode)
+{
+    set_t *universe = lines[0].ref;
+    set_t **sets;
+    int *results; // results of rows of the current block
+    bool jaccard = !strcmp(operation, JACCARD);
+    bool dense = layout != NULL;
+    int words = universe->numberOfItems / 64 + 1;
+    long total = 0; // number of elements of all sets
+    bool bitmaps;
+    int block;
+
+    if ((!jaccard && strcmp(operation, SUBSETEQ)) || (dense && strcmp(layout, DENSE)))
+    {
+        *errorCode = ARGS_ERR;
+        return;
+    }
+    if (allocate(sets, count * sizeof(set_t *)))
+    {
+        *errorCode = MEMORY_ERR;
+        return;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        if (arguments[i] > numberOfLines || lines[arguments[i] - 1].type != SET)
+        {
+            *errorCode = ARGS_ERR;
+            free(sets);
+            return;
+        }
+        sets[i] = lines[arguments[i] - 1].ref;
+        total += sets[i]->numberOfItems;
+    }
+
+    // a word of bitmap covers 64 elements, so bitmaps pay off unless sets are very sparse
+    bitmaps = words <= 2 * (total / count + 1);
+    block = CACHE_BLOCK / (2 * (bitmaps ? words * (int)sizeof(uint64_t) : (int)(total / count + 1) * (int)sizeof(int)));
+    if (block < 1)
+        block = 1;
+    if (block > count)
+        block = count;
+    for (int i = 0; i < count && !*errorCode; i++)
+        if ((bitmaps ? (void *)__bits(sets[i], universe) : (void *)__sorted(sets[i])) == NULL)
+            *errorCode = MEMORY_ERR;
+    if (*errorCode || allocate(results, (long)block * count * sizeof(int)))
+    {
+        *errorCode = MEMORY_ERR;
+        free(sets);
+        return;
+    }
+
+    // rows of block are split between threads, bitmaps and sorted ids are only read by them
+    matrix_t matrix = {sets, count, words, bitmaps, jaccard, dense, 0, results};
+    long cost = (long)count * (bitmaps ? words : total / count + 1); // operations of one row
+
+    fputc(MATRIX_TYPE, output);
+    for (int first = 0; first < count; first += block)
+    {
+        int last = first + block < count ? first + block : count;
+
+        matrix.first = first;
+        __parallel(__matrixRows, &matrix, last - first, __parts(last - first, cost * (last - first)));
+
+        // prints rows of the block
+        for (int i = first; i < last; i++)
+        {
+            int *row = &results[(long)(i - first) * count];
+
+            if (dense)
+                fprintf(output, " (");
+            for (int j = 0; j < count; j++)
+            {
+                if (dense && jaccard)
+                    fprintf(output, j ? " %g" : "%g", __jaccard(row[j], sets[i]->numberOfItems, sets[j]->numberOfItems));
+                else if (dense)
+                    fprintf(output, j ? " %d" : "%d", row[j]);
+                else if (jaccard && j > i && row[j])
+                    fprintf(output, " (%d %d %g)", arguments[i], arguments[j], __jaccard(row[j], sets[i]->numberOfItems, sets[j]->numberOfItems));
+                else if (!jaccard && row[j])
+                    fprintf(output, " (%d %d)", arguments[i], arguments[j]);
+            }
+            if (dense)
+                fputc(')', output);
+        }
+    }
+    free(results);
+    free(sets);
+}
+
+// computes rows of block of matrix for one thread
+static void *__matrixRows(void *arg)
+{
+    part_t *part = arg;
+    matrix_t *matrix = part->shared;
+    set_t **sets = matrix->sets;
+
+    for (int j = 0; j < matrix->count; j++)
+        for (int i = matrix->first + part->first; i < matrix->first + part->last; i++)
+        {
+            int *result = &matrix->results[(long)(i - matrix->first) * matrix->count + j];
+
+            if (!matrix->dense && matrix->jaccard && j <= i) // sparse jaccard leaves out diagonal and symmetric half
+                continue;
+            if (matrix->bitmaps && !matrix->jaccard)
+                *result = __subseteqBits(sets[i]->bits, sets[j]->bits, matrix->words);
+            else if (matrix->bitmaps)
+                *result = __commonBits(sets[i]->bits, sets[j]->bits, matrix->words);
+            else
+                *result = __commonSorted(sets[i]->sorted, sets[i]->numberOfItems, sets[j]->sorted, sets[j]->numberOfItems);
+            if (!matrix->bitmaps && !matrix->jaccard)
+                *result = *result == sets[i]->numberOfItems;
+        }
+    return NULL;
+}
+
+// component for Reflexive
+static bool __reflexive(rel_t *rel, set_t *universe)
+{
+    int count = 0;
+    for (int i = 0; i < rel->numberOfPairs; i++)
+        count += rel->left[i] == rel->right[i];
+    return count == universe->numberOfItems;
+}
+
+// Reflexive
+static void RelReflexive(rel_t *rel, set_t *universe)
+{
+    fprintf(output, __reflexive(rel, universe) ? _TRUE : _FALSE);
+}
+
+// component for Symmetric, successors of each element are its predecessors (both lists are sorted)
+static bool __symmetric(rel_t *rel, set_t *universe, int *errorCode)
+{
+    graph_t *graph;
+
+    if ((graph = __graph(rel, universe, errorCode)) == NULL)
+        return false;
+    for (int u = 0; u < graph->vertices; u++)
+    {
+        int count = graph->outStart[u + 1] - graph->outStart[u];
+
+        if (count != graph->inStart[u + 1] - graph->inStart[u] ||
+            memcmp(graph->outAdj + graph->outStart[u], graph->inAdj + graph->inStart[u], count * sizeof(int)))
+            return false;
+    }
+    return true;
+}
+
+// Symmetric
+static void RelSymmetric(rel_t *rel, set_t *universe, int *errorCode)
+{
+    bool result = __symmetric(rel, universe, errorCode);
+
+    if (!*errorCode)
+        fprintf(output, result ? _TRUE : _FALSE);
+}
+
+// component for Antisymmetric, no successor of an element but itself is its predecessor (lists are sorted, so they are merged)
+static bool __antisymmetric(rel_t *rel, set_t *universe, int *errorCode)
+{
+    graph_t *graph;
+
+    if ((graph = __graph(rel, universe, errorCode)) == NULL)
+        return false;
+    for (int u = 0; u < graph->vertices; u++)
+    {
+        int i = graph->inStart[u];
+
+        for (int k = graph->outStart[u]; k < graph->outStart[u + 1]; k++)
+        {
+            int v = graph->outAdj[k];
+
+            while (i < graph->inStart[u + 1] && graph->inAdj[i] < v)
+                i++;
+            if (v != u && i < graph->inStart[u + 1] && graph->inAdj[i] == v)
+                return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Returns true or false if relation is Antisymmetric
+ *
+ */
+static void RelAntisymmetric(rel_t *rel, set_t *universe, int *errorCode)
+{
+    bool result = __antisymmetric(rel, universe, errorCode);
+
+    if (!*errorCode)
+        fprintf(output, result ? _TRUE : _FALSE);
+}
+
+// component for Transitive
+static bool __transitive(rel_t *rel, set_t *universe, int *errorCode)
+{
+    graph_t *graph;
+    int middle, last;
+
+    if ((graph = __graph(rel, universe, errorCode)) == NULL)
+        return false;
+    return __intransitive(graph, &middle, &last) == -1;
+}
+
+/*
+ * Returns true or false if relation is Transitive
+ *
+ */
+static void RelTransitive(rel_t *rel, set_t *universe, int *errorCode)
+{
+    bool result = __transitive(rel, universe, errorCode);
+
+    if (!*errorCode)
+        fprintf(output, result ? _TRUE : _FALSE);
+}
+
+// elements are looked up in degrees, false without memory for them
+static bool __func(rel_t *rel, set_t *universe, int *errorCode)
+{
+    if (__degrees(rel))
+    {
+        *errorCode = MEMORY_ERR;
+        return false;
+    }
+    for (int i = 0; i < universe->numberOfItems; i++)
+        if (__degree(rel, 0, universe->ids[i]) > 1)
+            return false;
+    return true;
+}
+
+// Function
+static void RelFunction(rel_t *rel, set_t *universe, int *errorCode)
+{
+    bool result = __func(rel, universe, errorCode);
+
+    if (!*errorCode)
+        fprintf(output, result ? _TRUE : _FALSE);
+}
+
+/*
+ * Counts first and second elements of pairs by one pass over relation, returns
+ * error code. Pairs of a large relation are split between threads, each thread
+ * counts its part into its own counters (the first one into the relation) and
+ * the counters are summed. A thread gets at least as many pairs as its
+ * counters have elements, so sparse relations over large universes don't
+ * multiply memory.
+ */
+static int __degrees(rel_t *rel)
+{
+    degrees_t degrees;
+    int parts;
+
+    if (rel->degree[0] != NULL)
+        return EXIT_SUCCESS;
+
+    degrees.rel = rel;
+    degrees.phase = DEGREE_SIZE;
+    parts = __parts(rel->numberOfPairs, rel->numberOfPairs);
+    __parallel(__degreesPart, &degrees, rel->numberOfPairs, parts);
+    rel->degreeSize = 0;
+    for (int i = 0; i < parts; i++)
+        if (degrees.size[i] > rel->degreeSize)
+            rel->degreeSize = degrees.size[i];
+
+    if ((rel->degree[0] = calloc(rel->degreeSize + 1, sizeof(int))) == NULL ||
+        (rel->degree[1] = calloc(rel->degreeSize + 1, sizeof(int))) == NULL)
+    {
+        free(rel->degree[0]);
+        rel->degree[0] = NULL;
+        return MEMORY_ERR;
+    }
+    parts = __parts(rel->numberOfPairs / (rel->degreeSize + 1), rel->numberOfPairs);
+    degrees.degree[0][0] = rel->degree[0];
+    degrees.degree[0][1] = rel->degree[1];
+    for (int i = 1; i < parts; i++) // parts without memory for counters are left out
+        if ((degrees.degree[i][0] = calloc(rel->degreeSize + 1, sizeof(int))) == NULL ||
+            (degrees.degree[i][1] = calloc(rel->degreeSize + 1, sizeof(int))) == NULL)
+        {
+            free(degrees.degree[i][0]);
+            parts = i;
+        }
+
+    degrees.phase = DEGREE_COUNT;
+    __parallel(__degreesPart, &degrees, rel->numberOfPairs, parts);
+    rel->loops = 0;
+    for (int i = 0; i < parts; i++)
+        rel->loops += degrees.loops[i];
+    if (parts > 1)
+    {
+        degrees.phase = DEGREE_MERGE;
+        degrees.parts = parts;
+        __parallel(__degreesPart, &degrees, rel->degreeSize, parts);
+        for (int i = 1; i < parts; i++)
+        {
+            free(degrees.degree[i][0]);
+            free(degrees.degree[i][1]);
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+// computes phase of counting degrees for part of pairs (or elements)
+static void *__degreesPart(void *arg)
+{
+    part_t *part = arg;
+    degrees_t *degrees = part->shared;
+    rel_t *rel = degrees->rel;
+    int i = part->index;
+
+    switch (degrees->phase)
+    {
+    case DEGREE_SIZE:
+        degrees->size[i] = 0;
+        for (int j = part->first; j < part->last; j++)
+        {
+            if ((int)rel->left[j] >= degrees->size[i])
+                degrees->size[i] = rel->left[j] + 1;
+            if ((int)rel->right[j] >= degrees->size[i])
+                degrees->size[i] = rel->right[j] + 1;
+        }
+        break;
+    case DEGREE_COUNT:
+        degrees->loops[i] = 0;
+        for (int j = part->first; j < part->last; j++)
+        {
+            degrees->degree[i][0][rel->left[j]]++;
+            degrees->degree[i][1][rel->right[j]]++;
+            degrees->loops[i] += rel->left[j] == rel->right[j];
+        }
+        break;
+    case DEGREE_MERGE: // counters of the other parts are added to the relation
+        for (int k = 0; k < PAIR; k++)
+            for (int p = 1; p < degrees->parts; p++)
+                for (int j = part->first; j < part->last; j++)
+                    rel->degree[k][j] += degrees->degree[p][k][j];
+        break;
+    case DEGREE_MAX:
+        for (int k = 0; k < PAIR; k++)
+        {
+            degrees->max[i][k] = 0;
+            degrees->hub[i][k] = -1;
+            for (int j = part->first; j < part->last; j++)
+                if (rel->degree[k][j] > degrees->max[i][k])
+                {
+                    degrees->max[i][k] = rel->degree[k][j];
+                    degrees->hub[i][k] = j;
+                }
+        }
+        break;
+    case DEGREE_HISTOGRAM: // elements of universe, the ones after the largest element of pairs have degree 0
+        for (int k = 0; k < PAIR; k++)
+            for (int j = part->first; j < part->last; j++)
+                degrees->histogram[i][k][__degree(rel, k, j)]++;
+        break;
+    }
+    return NULL;
+}
+
+// returns number of pairs whose first (column 0) or second (column 1) element is id, degrees have to be counted
+static int __degree(rel_t *rel, int column, int id)
+{
+    return id < rel->degreeSize ? rel->degree[column][id] : 0;
+}
+
+/*
+ * Prints shape of relation: number of pairs, elements of universe, pairs (a a)
+ * and density (pairs / elements^2), the largest out-degree and in-degree with
+ * the first element having it, and histograms of out-degrees and in-degrees of
+ * all elements of universe as degree:elements.
+ */
+static void RelStats(rel_t *rel, set_t *universe, int *errorCode)
+{
+    int n = universe->numberOfItems;
+    int *histogram[PAIR] = {NULL, NULL}; // number of elements with each degree
+    int max[PAIR] = {0, 0};
+    int hub[PAIR] = {-1, -1}; // the first element with the largest degree
+    degrees_t degrees;        // the largest degrees and histograms of parts of elements
+    int parts;
+
+    if ((*errorCode = __degrees(rel)))
+        return;
+
+    // parts are in order of elements, so the first part with the largest degree has the first element with it
+    degrees.rel = rel;
+    degrees.phase = DEGREE_MAX;
+    parts = __parts(rel->degreeSize, rel->degreeSize);
+    __parallel(__degreesPart, &degrees, rel->degreeSize, parts);
+    for (int i = 0; i < parts; i++)
+        for (int k = 0; k < PAIR; k++)
+            if (degrees.max[i][k] > max[k])
+            {
+                max[k] = degrees.max[i][k];
+                hub[k] = degrees.hub[i][k];
+            }
+
+    // each part counts its own histograms (the first one into the result), they are summed
+    if ((histogram[0] = calloc(max[0] + 1, sizeof(int))) == NULL ||
+        (histogram[1] = calloc(max[1] + 1, sizeof(int))) == NULL)
+    {
+        free(histogram[0]);
+        *errorCode = MEMORY_ERR;
+        return;
+    }
+    parts = __parts(n / (max[0] + max[1] + 2), n); // a part counts at least as many elements as its histograms have
+    degrees.histogram[0][0] = histogram[0];
+    degrees.histogram[0][1] = histogram[1];
+    for (int i = 1; i < parts; i++) // parts without memory for histograms are left out
+        if ((degrees.histogram[i][0] = calloc(max[0] + 1, sizeof(int))) == NULL ||
+            (degrees.histogram[i][1] = calloc(max[1] + 1, sizeof(int))) == NULL)
+        {
+            free(degrees.histogram[i][0]);
+            parts = i;
+        }
+    degrees.phase = DEGREE_HISTOGRAM;
+    __parallel(__degreesPart, &degrees, n, parts);
+    for (int i = 1; i < parts; i++)
+        for (int k = 0; k < PAIR; k++)
+        {
+            for (int d = 0; d <= max[k]; d++)
+                histogram[k][d] += degrees.histogram[i][k][d];
+            free(degrees.histogram[i][k]);
+        }
+
+    fprintf(output, "pairs %d elements %d loops %d density %g", rel->numberOfPairs, n, rel->loops,
+            n ? (double)rel->numberOfPairs / n / n : 0.0);
+    for (int k = 0; k < PAIR; k++)
+    {
+        fprintf(output, k ? " in-max %d" : " out-max %d", max[k]);
+        if (hub[k] >= 0)
+            PrintElement(universe, hub[k]);
+    }
+    for (int k = 0; k < PAIR; k++)
+    {
+        fputs(k ? " in" : " out", output);
+        for (int d = 0; d <= max[k]; d++)
+            if (histogram[k][d])
+                fprintf(output, " %d:%d", d, histogram[k][d]);
+        free(histogram[k]);
+    }
+}
+
+// prints at most count elements with the largest out-degree (or in-degree) as (element degree), ties in order of universe
+static void RelTopK(rel_t *rel, set_t *universe, int count, bool in, int *errorCode)
+{
+    uint64_t *keys; // degree (the largest first) and element
+    int size = 0;
+
+    if ((*errorCode = __degrees(rel)) || allocate(keys, (rel->degreeSize + 1) * sizeof(uint64_t)))
+    {
+        *errorCode = MEMORY_ERR;
+        return;
+    }
+    for (int i = 0; i < rel->degreeSize; i++)
+        if (rel->degree[in][i])
+            keys[size++] = (uint64_t)(INT32_MAX - rel->degree[in][i]) << 32 | (uint32_t)i;
+    qsort(keys, size, sizeof(uint64_t), __compareKeys);
+
+    for (int i = 0; i < size && i < count; i++)
+    {
+        fputs(i ? " (" : "(", output);
+        PrintName(universe, keys[i] & UINT32_MAX);
+        fprintf(output, " %d)", INT32_MAX - (int)(keys[i] >> 32));
+    }
+    free(keys);
+}
+
+// component for Domain and Codomain, writes elements of universe which are first (or second) in some pair into ids
+static int __domain(rel_t *rel, set_t *universe, int numberOfElement, int *ids)
+{
+    uint32_t *column = numberOfElement ? rel->right : rel->left;
+    int count = 0;
+
+    // marks elements in ids first, then moves marked ones to the front (in order of universe)
+    memset(ids, 0, universe->numberOfItems * sizeof(int));
+    for (int j = 0; j < rel->numberOfPairs; j++)
+        ids[column[j]] = 1;
+    for (int i = 0; i < universe->numberOfItems; i++)
+        if (ids[i])
+            ids[count++] = i;
+    return count;
+}
+
+// Domain
+static void RelDomain(rel_t *rel, set_t *universe, int *errorCode)
+{
+    int *ids;
+    if (allocate(ids, (universe->numberOfItems + 1) * sizeof(int)))
+    {
+        *errorCode = MEMORY_ERR;
+        return;
+    }
+    PrintElements(universe, ids, __domain(rel, universe, 0, ids));
+    free(ids);
+}
+
+// Codomain
+static void RelCodomain(rel_t *rel, set_t *universe, int *errorCode)
+{
+    int *ids;
+    if (allocate(ids, (universe->numberOfItems + 1) * sizeof(int)))
+    {
+        *errorCode = MEMORY_ERR;
+        return;
+    }
+    PrintElements(universe, ids, __domain(rel, universe, 1, ids));
+    free(ids);
+}
+
+// component of injective function, degrees are built by __func
+static bool __inject(rel_t *rel, set_t *set1, set_t *set2, int *errorCode)
+{
+    if (!__func(rel, set1, errorCode))
+        return false;
+    for (int i = 0; i < set2->numberOfItems; i++)
+        if (__degree(rel, 1, set2->ids[i]) > 1)
+            return false;
+    return true;
+}
+
+static bool __inSet(rel_t *rel, set_t *set, int numberOfElement)
+{
+    uint32_t *column = numberOfElement ? rel->right : rel->left;
+    for (int i = 0; i < rel->numberOfPairs; i++)
+        if (!__contains(set, column[i]))
+            return false;
+    return true;
+}
+
+// component for Injective
+static bool __injective(rel_t *rel, set_t *set1, set_t *set2, int *errorCode)
+{
+    return __inSet(rel, set1, 0) && __inSet(rel, set2, 1) && __inject(rel, set1, set2, errorCode);
+}
+
+// component for Surjective
+static bool __surjective(rel_t *rel, set_t *set1, set_t *set2, int *errorCode)
+{
+    return __inSet(rel, set1, 0) && __inSet(rel, set2, 1) && __func(rel, set1, errorCode);
+}
+
+// component for Bijective
+static bool __bijective(rel_t *rel, set_t *set1, set_t *set2, int *errorCode)
+{
+    return __inSet(rel, set1, 0) && __inSet(rel, set2, 1) && __inject(rel, set1, set2, errorCode);
+}
+
+static void RelInjective(rel_t *rel, set_t *set1, set_t *set2, int *errorCode)
+{
+    bool result = __injective(rel, set1, set2, errorCode);
+
+    if (!*errorCode)
+        fprintf(output, result ? _TRUE : _FALSE);
+}
+
+static void RelSurjective(rel_t *rel, set_t *set1, set_t *set2, int *errorCode)
+{
+    bool result = __surjective(rel, set1, set2, errorCode);
+
+    if (!*errorCode)
+        fprintf(output, result ? _TRUE : _FALSE);
+}
+
+static void RelBijective(rel_t *rel, set_t *set1, set_t *set2, int *errorCode)
+{
+    bool result = __bijective(rel, set1, set2, errorCode);
+
+    if (!*errorCode)
+        fprintf(output, result ? _TRUE : _FALSE);
+}
+
+// fingerprint of string (64-bit FNV-1a)
+static uint64_t __fingerprint(const char *str)
+{
+    uint64_t hash = 14695981039346656037ull;
+    while (*str)
+        hash = (hash ^ (unsigned char)*str++) * 1099511628211ull;
+    return hash;
+}
+
+// mixes bits of value (finalizer of splitmix64)
+static uint64_t __mix(uint64_t value)
+{
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
+
+// hash of string (FNV-1a)
+static uint32_t __hash(const char *str)
+{
+    uint32_t hash = 2166136261u;
+    while (*str)
+        hash = (hash ^ (unsigned char)*str++) * 16777619u;
+    return hash;
+}
+
+// returns index of item in set or -1 if set doesn't contain it
+static int __indexOf(set_t *set, const char *item)
+{
+    if (set->index == NULL)
+    {
+        // builds hash index on first lookup (open addressing, capacity is power of two)
+        int capacity = 1;
+        while (capacity < 2 * set->numberOfItems)
+            capacity <<= 1;
+        if ((set->index = calloc(capacity, sizeof(int))) != NULL)
+        {
+            set->indexCapacity = capacity;
+            for (int i = 0; i < set->numberOfItems; i++)
+            {
+                int slot = __hash(set->items[i]) & (capacity - 1);
+                while (set->index[slot])
+                    slot = (slot + 1) & (capacity - 1);
+                set->index[slot] = i + 1;
+            }
+        }
+    }
+    if (set->index == NULL) // if there is no memory for index, searches linearly
+    {
+        for (int i = 0; i < set->numberOfItems; i++)
+            if (!strcmp(set->items[i], item))
+                return i;
+        return -1;
+    }
+    for (int slot = __hash(item) & (set->indexCapacity - 1); set->index[slot]; slot = (slot + 1) & (set->indexCapacity - 1))
+        if (!strcmp(set->items[set->index[slot] - 1], item))
+            return set->index[slot] - 1;
+    return -1;
+}
+
+// frees graph of relation
+static void __freeGraph(graph_t *graph)
+{
+    if (graph == NULL)
+        return;
+    free(graph->component);
+    free(graph->memberStart);
+    free(graph->members);
+    free(graph->pre);
+    free(graph->post);
+    free(graph->low);
+    free(graph->mark);
+    free(graph->outStart);
+    free(graph->outAdj);
+    free(graph->inStart);
+    free(graph->inAdj);
+    for (int k = 0; k < PAIR; k++)
+    {
+        free(graph->seen[k]);
+        free(graph->dist[k]);
+    }
+    free(graph->queue);
+    free(graph);
+}
+
+// returns graph of relation, builds it on first call
+static graph_t *__graph(rel_t *rel, set_t *universe, int *errorCode)
+{
+    if (rel->graph != NULL)
+        return rel->graph;
+
+    graph_t *graph;
+    int n = universe->numberOfItems;
+    int m = rel->numberOfPairs;
+    int *cursor; // next free position in adjacency of each element
+
+    if ((graph = calloc(1, sizeof(graph_t))) == NULL)
+    {
+        *errorCode = MEMORY_ERR;
+        return NULL;
+    }
+    graph->vertices = n;
+    graph->outStart = calloc(n + 1, sizeof(int));
+    graph->inStart = calloc(n + 1, sizeof(int));
+    graph->outAdj = malloc((m + 1) * sizeof(int));
+    graph->inAdj = malloc((m + 1) * sizeof(int));
+    graph->queue = malloc((2 * n + 1) * sizeof(int));
+    for (int k = 0; k < PAIR; k++)
+    {
+        graph->seen[k] = calloc(n + 1, sizeof(int));
+        graph->dist[k] = malloc((n + 1) * sizeof(int));
+    }
+    cursor = malloc((n + 1) * sizeof(int));
+    if (graph->outStart == NULL || graph->inStart == NULL || graph->outAdj == NULL || graph->inAdj == NULL || graph->queue == NULL ||
+        graph->seen[0] == NULL || graph->seen[1] == NULL || graph->dist[0] == NULL || graph->dist[1] == NULL || cursor == NULL)
+    {
+        free(cursor);
+        __freeGraph(graph);
+        *errorCode = MEMORY_ERR;
+        return NULL;
+    }
+
+    // counts predecessors and successors of each element
+    for (int i = 0; i < m; i++)
+    {
+        graph->inStart[rel->right[i] + 1]++;
+        graph->outStart[rel->left[i] + 1]++;
+    }
+    for (int v = 0; v < n; v++)
+    {
+        graph->inStart[v + 1] += graph->inStart[v];
+        graph->outStart[v + 1] += graph->outStart[v];
+    }
+    // buckets pairs by the second element
+    memcpy(cursor, graph->inStart, n * sizeof(int));
+    for (int i = 0; i < m; i++)
+        graph->inAdj[cursor[rel->right[i]]++] = rel->left[i];
+
+    // transposes predecessors into successors, so successors come out sorted
+    memcpy(cursor, graph->outStart, n * sizeof(int));
+    for (int v = 0; v < n; v++)
+        for (int k = graph->inStart[v]; k < graph->inStart[v + 1]; k++)
+            graph->outAdj[cursor[graph->inAdj[k]]++] = v;
+    // and back, so predecessors are sorted too
+    memcpy(cursor, graph->inStart, n * sizeof(int));
+    for (int u = 0; u < n; u++)
+        for (int k = graph->outStart[u]; k < graph->outStart[u + 1]; k++)
+            graph->inAdj[cursor[graph->outAdj[k]]++] = u;
+
+    free(cursor);
+    rel->graph = graph;
+    return graph;
+}
+
+// returns length of the shortest path from one element to another or -1 (bidirectional breadth-first search)
+static int __distance(graph_t *graph, int from, int to)
+{
+    if (from == to)
+        return 0;
+
+    int stamp = ++graph->stamp;
+    int *queue[PAIR] = {graph->queue, graph->queue + graph->vertices}; // forward and backward queue
+    int *start[PAIR] = {graph->outStart, graph->inStart};
+    int *adj[PAIR] = {graph->outAdj, graph->inAdj};
+    int head[PAIR] = {0, 0};
+    int tail[PAIR] = {1, 1};
+    int best = -1;
+
+    queue[0][0] = from;
+    graph->seen[0][from] = stamp;
+    graph->dist[0][from] = 0;
+    queue[1][0] = to;
+    graph->seen[1][to] = stamp;
+    graph->dist[1][to] = 0;
+
+    while (head[0] < tail[0] && head[1] < tail[1])
+    {
+        // expands one whole level of the smaller side
+        int side = (tail[0] - head[0] <= tail[1] - head[1]) ? 0 : 1;
+        int levelEnd = tail[side];
+
+        for (; head[side] < levelEnd; head[side]++)
+        {
+            int u = queue[side][head[side]];
+            for (int k = start[side][u]; k < start[side][u + 1]; k++)
+            {
+                int v = adj[side][k];
+                if (graph->seen[!side][v] == stamp && (best == -1 || graph->dist[side][u] + 1 + graph->dist[!side][v] < best))
+                    best = graph->dist[side][u] + 1 + graph->dist[!side][v];
+                if (graph->seen[side][v] != stamp)
+                {
+                    graph->seen[side][v] = stamp;
+                    graph->dist[side][v] = graph->dist[side][u] + 1;
+                    queue[side][tail[side]++] = v;
+                }
+            }
+        }
+        // the sides met within this level, so there is no shorter path
+        if (best != -1)
+            return best;
+    }
+    return -1;
+}
+
+/*
+ * Returns strongly connected component of each element, or NULL if there is no memory
+ * Components are numbered in reverse topological order. Tarjan's algorithm runs
+ * with its own call stack, so depth of relation isn't limited by the program stack.
+ */
+static int *__scc(graph_t *graph, int *errorCode)
+{
+    int n = graph->vertices;
+    int *component = malloc((n + 1) * sizeof(int));
+    int *order = calloc(n + 1, sizeof(int)); // order of discovery, 0 if element wasn't visited yet
+    int *low = malloc((n + 1) * sizeof(int)); // lowest order reachable from subtree of element
+    int *stack = malloc((n + 1) * sizeof(int)); // visited elements without component
+    int *call = malloc((n + 1) * sizeof(int)); // elements of the current search path
+    int *edge = malloc((n + 1) * sizeof(int)); // next successor to visit of each element on the path
+
+    if (component == NULL || order == NULL || low == NULL || stack == NULL || call == NULL || edge == NULL)
+    {
+        free(component);
+        component = NULL;
+        *errorCode = MEMORY_ERR;
+    }
+    else
+    {
+        int counter = 0, components = 0, stackSize = 0, callSize = 0;
+
+        for (int u = 0; u < n; u++)
+            component[u] = -1;
+
+        for (int root = 0; root < n; root++)
+        {
+            if (order[root])
+                continue;
+            order[root] = low[root] = ++counter;
+            stack[stackSize++] = root;
+            call[callSize++] = root;
+            edge[root] = graph->outStart[root];
+
+            while (callSize)
+            {
+                int u = call[callSize - 1];
+                if (edge[u] < graph->outStart[u + 1])
+                {
+                    int v = graph->outAdj[edge[u]++];
+                    if (!order[v]) // descends into successor
+                    {
+                        order[v] = low[v] = ++counter;
+                        stack[stackSize++] = v;
+                        call[callSize++] = v;
+                        edge[v] = graph->outStart[v];
+                    }
+                    else if (component[v] == -1 && order[v] < low[u]) // successor is still on stack
+                        low[u] = order[v];
+                    continue;
+                }
+
+                // all successors are done, returns to predecessor
+                if (--callSize && low[u] < low[call[callSize - 1]])
+                    low[call[callSize - 1]] = low[u];
+                if (low[u] == order[u])
+                {
+                    int v;
+                    do
+                    {
+                        v = stack[--stackSize];
+                        component[v] = components;
+                    } while (v != u);
+                    components++;
+                }
+            }
+        }
+    }
+
+    free(order);
+    free(low);
+    free(stack);
+    free(call);
+    free(edge);
+    return component;
+}
+
+/*
+ * Builds labels of reachability, returns error code. Strongly connected
+ * components are condensed into a DAG which is searched depth first: pre and
+ * post number each component when the search enters and leaves it, and low is
+ * the lowest post of components reachable from it. A component reaching
+ * another contains its interval [low, post], and one whose pre and post
+ * enclose the other's reaches it by the tree of the search.
+ */
+static int __labels(graph_t *graph)
+{
+    int errorCode = 0;
+    int n = graph->vertices;
+    int *component = __scc(graph, &errorCode);
+    int count = 0;
+    int *member = NULL; // next member of each component on the search path whose successors are visited
+    int *edge = NULL;   // next successor of that member
+    int pre = 0, post = 0, depth = 0;
+    int *path = graph->queue;
+
+    if (component == NULL)
+        return errorCode;
+    for (int u = 0; u < n; u++)
+        if (component[u] >= count)
+            count = component[u] + 1;
+    graph->memberStart = calloc(count + 2, sizeof(int));
+    graph->members = malloc((n + 1) * sizeof(int));
+    graph->pre = malloc((count + 1) * sizeof(int));
+    graph->post = calloc(count + 1, sizeof(int));
+    graph->low = malloc((count + 1) * sizeof(int));
+    graph->mark = calloc(count + 1, sizeof(int));
+    member = malloc((count + 1) * sizeof(int));
+    edge = malloc((count + 1) * sizeof(int));
+    if (graph->memberStart == NULL || graph->members == NULL || graph->pre == NULL || graph->post == NULL || graph->low == NULL ||
+        graph->mark == NULL || member == NULL || edge == NULL)
+    {
+        free(component);
+        free(member);
+        free(edge);
+        return MEMORY_ERR;
+    }
+
+    // buckets elements by component
+    for (int u = 0; u < n; u++)
+        graph->memberStart[component[u] + 2]++;
+    for (int c = 0; c < count; c++)
+        graph->memberStart[c + 2] += graph->memberStart[c + 1];
+    for (int u = 0; u < n; u++)
+        graph->members[graph->memberStart[component[u] + 1]++] = u;
+
+    // components are numbered in reverse topological order, so the search starts from sources
+    for (int root = count - 1; root >= 0; root--)
+    {
+        if (graph->post[root])
+            continue;
+        path[depth++] = root;
+        graph->pre[root] = ++pre;
+        graph->low[root] = INT32_MAX;
+        member[root] = graph->memberStart[root];
+        edge[root] = graph->outStart[graph->members[member[root]]];
+
+        while (depth)
+        {
+            int c = path[depth - 1];
+            int u = graph->members[member[c]];
+
+            if (edge[c] == graph->outStart[u + 1]) // the next member of component
+            {
+                if (++member[c] < graph->memberStart[c + 1])
+                {
+                    edge[c] = graph->outStart[graph->members[member[c]]];
+                    continue;
+                }
+                // all successors are done, component is left
+                graph->post[c] = ++post;
+                if (graph->post[c] < graph->low[c])
+                    graph->low[c] = graph->post[c];
+                if (--depth && graph->low[c] < graph->low[path[depth - 1]])
+                    graph->low[path[depth - 1]] = graph->low[c];
+                continue;
+            }
+
+            int d = component[graph->outAdj[edge[c]++]];
+            if (d == c)
+                continue;
+            if (graph->post[d]) // successor was left already (the only visited components out of the path in DAG)
+            {
+                if (graph->low[d] < graph->low[c])
+                    graph->low[c] = graph->low[d];
+                continue;
+            }
+            path[depth++] = d;
+            graph->pre[d] = ++pre;
+            graph->low[d] = INT32_MAX;
+            member[d] = graph->memberStart[d];
+            edge[d] = graph->outStart[graph->members[member[d]]];
+        }
+    }
+
+    free(member);
+    free(edge);
+    graph->component = component;
+    graph->components = count;
+    return EXIT_SUCCESS;
+}
+
+// returns true if component from reaches component to by the labels, or false if it can't reach it; search decides the rest
+#define CONTAINS(graph, c, d) ((graph)->post[d] <= (graph)->post[c] && (graph)->low[d] >= (graph)->low[c])
+#define ENCLOSES(graph, c, d) ((graph)->pre[d] >= (graph)->pre[c] && (graph)->post[d] <= (graph)->post[c])
+
+// returns true if element to is reachable from element from
+static bool __reaches(graph_t *graph, int from, int to)
+{
+    if (graph->component == NULL && __labels(graph))
+        return from == to || __distance(graph, from, to) != -1; // if there is no memory for labels, searches from both sides
+
+    int source = graph->component[from];
+    int target = graph->component[to];
+
+    if (source == target || ENCLOSES(graph, source, target))
+        return true;
+    if (!CONTAINS(graph, source, target))
+        return false;
+
+    // search of condensation which leaves out components whose labels can't contain the target
+    int stamp = ++graph->stamp;
+    int size = 0;
+
+    graph->queue[size++] = source;
+    graph->mark[source] = stamp;
+    while (size)
+    {
+        int c = graph->queue[--size];
+        for (int i = graph->memberStart[c]; i < graph->memberStart[c + 1]; i++)
+        {
+            int u = graph->members[i];
+            for (int k = graph->outStart[u]; k < graph->outStart[u + 1]; k++)
+            {
+                int d = graph->component[graph->outAdj[k]];
+                if (graph->mark[d] == stamp || !CONTAINS(graph, d, target))
+                    continue;
+                if (ENCLOSES(graph, d, target))
+                    return true;
+                graph->mark[d] = stamp;
+                graph->queue[size++] = d;
+            }
+        }
     }
+    return false;
+}
 
-    // free
+// Reach
+static void RelReach(rel_t *rel, set_t *universe, char *from, char *to, int *errorCode)
+{
+    graph_t *graph;
+    int a = __indexOf(universe, from);
+    int b = __indexOf(universe, to);
 
-    // if there is an error
-    if (*errorCode)
+    if (a < 0 || b < 0)
     {
-        for (int i = 0; i < set->numberOfItems; i++)
-            free(set->items[i]);
-        free(set->items);
-        free(set);
-
-        return NULL;
+        *errorCode = ARGS_ERR;
+        return;
     }
+    if ((graph = __graph(rel, universe, errorCode)) == NULL)
+        return;
 
-    return set;
+    fprintf(output, __reaches(graph, a, b) ? _TRUE : _FALSE);
 }
 
-// prints set
-void PrintSet(set_t *set) //??
+// returns pair i of relation as one key, first element in upper 32 bits
+static uint64_t __pairKey(rel_t *rel, int i)
 {
-    putchar(SET);
-    for (int i = 0; i < set->numberOfItems; i++)
-    {
-        printf(" %s", set->items[i]);
-    }
+    return (uint64_t)rel->left[i] << 32 | rel->right[i];
 }
 
-// checks if elements in set are equal
-int CheckSameElems(set_t *set)
+// returns true if relation contains pair with key
+static bool __containsPair(rel_t *rel, uint64_t key)
 {
-    for (int i = 0; i < set->numberOfItems - 1; i++)
-        for (int j = i + 1; j < set->numberOfItems; j++)
-            if (!strcmp(set->items[i], set->items[j]))
+    if (rel->index == NULL)
+    {
+        // builds hash index on first lookup (open addressing, capacity is power of two)
+        int capacity = 1;
+        while (capacity < 2 * rel->numberOfPairs)
+            capacity <<= 1;
+        if ((rel->index = calloc(capacity, sizeof(int))) != NULL)
+        {
+            rel->indexCapacity = capacity;
+            for (int i = 0; i < rel->numberOfPairs; i++)
             {
-                return ARGS_ERR;
+                int slot = __mix(__pairKey(rel, i)) & (capacity - 1);
+                while (rel->index[slot])
+                    slot = (slot + 1) & (capacity - 1);
+                rel->index[slot] = i + 1;
             }
-    return 0;
+        }
+    }
+    if (rel->index == NULL) // if there is no memory for index, searches linearly
+    {
+        for (int i = 0; i < rel->numberOfPairs; i++)
+            if (__pairKey(rel, i) == key)
+                return true;
+        return false;
+    }
+    for (int slot = __mix(key) & (rel->indexCapacity - 1); rel->index[slot]; slot = (slot + 1) & (rel->indexCapacity - 1))
+        if (__pairKey(rel, rel->index[slot] - 1) == key)
+            return true;
+    return false;
 }
 
-// validates set
-int ValidatesStringSet(char *str, void **ref, set_t *universe)
+// prints pairs of rel1 which are (in) or aren't in rel2, or all of them
+static void PrintPairs(set_t *universe, rel_t *rel1, rel_t *rel2, bool in, bool all)
 {
+    for (int i = 0; i < rel1->numberOfPairs; i++)
+        if (all || __containsPair(rel2, __pairKey(rel1, i)) == in)
+            PrintPair(universe, rel1->left[i], rel1->right[i]);
+}
 
-    int length = strlen(str);
+// component for Subseteq of relations
+static bool __relSubseteq(rel_t *rel1, rel_t *rel2)
+{
+    if (rel1->numberOfPairs > rel2->numberOfPairs)
+        return false;
+    for (int i = 0; i < rel1->numberOfPairs; i++)
+        if (!__containsPair(rel2, __pairKey(rel1, i)))
+            return false;
+    return true;
+}
 
-    int errorCode = 0;
-    if (universe != NULL && str[0] == UNIVERSE) // if universum isn't null and the string is for universum it means that it's the second universum
-    {
+// Union of relations, pairs of rel1 and then pairs of rel2 which aren't in rel1
+static void RelUnion(rel_t *rel1, rel_t *rel2, set_t *universe)
+{
+    PrintTag(RELATION);
+    PrintPairs(universe, rel1, rel2, true, true);
+    PrintPairs(universe, rel2, rel1, false, false);
+}
 
-        return ARGS_ERR;
-    }
-    if (length == 1)
-    {
-        *ref = Save(str, &errorCode); // creates pointer to the structure
+// Intersect of relations
+static void RelIntersect(rel_t *rel1, rel_t *rel2, set_t *universe)
+{
+    PrintTag(RELATION);
+    PrintPairs(universe, rel1, rel2, true, false);
+}
 
-        return EXIT_SUCCESS;
-    }
-    for (int i = 1; i < length; i++) // if string has digits and etc..
-    {
-        if ((str[i] == ' ' && str[i - 1] == ' ') || !((str[i] >= 'A' && str[i] <= 'Z') || (str[i] >= 'a' && str[i] <= 'z') || str[i] == ' ')) // if string has 2 spaces in a row
-        {
-            errorCode = ARGS_ERR;
-            break;
-        }
-    }
+// Minus of relations
+static void RelMinus(rel_t *rel1, rel_t *rel2, set_t *universe)
+{
+    PrintTag(RELATION);
+    PrintPairs(universe, rel1, rel2, false, false);
+}
 
-    if (errorCode) // if there was an error
+// Subseteq of relations
+static void RelSubseteq(rel_t *rel1, rel_t *rel2)
+{
+    fprintf(output, __relSubseteq(rel1, rel2) ? _TRUE : _FALSE);
+}
+
+// Subset of relations
+static void RelSubset(rel_t *rel1, rel_t *rel2)
+{
+    fprintf(output, rel1->numberOfPairs < rel2->numberOfPairs && __relSubseteq(rel1, rel2) ? _TRUE : _FALSE);
+}
+
+// component for Equals of relations, relations with different fingerprints differ, the same fingerprint is confirmed by pairs
+static bool __relEquals(rel_t *rel1, rel_t *rel2)
+{
+    if (rel1 == rel2)
+        return true;
+    if (rel1->numberOfPairs != rel2->numberOfPairs || memcmp(rel1->digest, rel2->digest, sizeof(rel1->digest)))
+        return false;
+    return __relSubseteq(rel1, rel2);
+}
+
+// Equals of relations
+static void RelEquals(rel_t *rel1, rel_t *rel2)
+{
+    fprintf(output, __relEquals(rel1, rel2) ? _TRUE : _FALSE);
+}
+
+// Succ and Pred, prints successors (or predecessors) of element in relation
+static void RelSucc(rel_t *rel, set_t *universe, char *element, bool predecessors, int *errorCode)
+{
+    graph_t *graph;
+    int a = __indexOf(universe, element);
+
+    if (a < 0)
     {
-        return errorCode;
+        *errorCode = ARGS_ERR;
+        return;
     }
+    if ((graph = __graph(rel, universe, errorCode)) == NULL)
+        return;
 
-    *ref = Save(str, &errorCode); // creates pointer to the structure
+    if (predecessors)
+        PrintElements(universe, graph->inAdj + graph->inStart[a], graph->inStart[a + 1] - graph->inStart[a]);
+    else
+        PrintElements(universe, graph->outAdj + graph->outStart[a], graph->outStart[a + 1] - graph->outStart[a]);
+}
 
-    set_t *set = (set_t *)*ref;
-    if (errorCode) // if there was an error
+// Distance
+static void RelDistance(rel_t *rel, set_t *universe, char *from, char *to, int *errorCode)
+{
+    graph_t *graph;
+    int a = __indexOf(universe, from);
+    int b = __indexOf(universe, to);
+    int length;
+
+    if (a < 0 || b < 0)
     {
-        return errorCode;
+        *errorCode = ARGS_ERR;
+        return;
     }
+    if ((graph = __graph(rel, universe, errorCode)) == NULL)
+        return;
 
-    // checks if set has same elements
-    if ((errorCode = CheckSameElems(set)))
+    if ((length = __distance(graph, a, b)) != -1)
+        fprintf(output, "%d", length);
+    else
+        fprintf(output, _FALSE);
+}
+
+// returns representative of the element's class (path halving)
+static int __find(int *parent, int element)
+{
+    while (parent[element] != element)
     {
-        for (int i = 0; i < set->numberOfItems; i++)
-        {
-            free(set->items[i]);
-        }
-        free(set->items);
-        free(set);
-        return errorCode;
+        parent[element] = parent[parent[element]];
+        element = parent[element];
     }
+    return element;
+}
 
-    // checks if all the elements are in universum
-    if (universe != NULL)
+// merges classes of two elements (union by rank)
+static void __unite(int *parent, unsigned char *rank, int a, int b)
+{
+    if ((a = __find(parent, a)) == (b = __find(parent, b)))
+        return;
+    if (rank[a] < rank[b])
+        parent[a] = b;
+    else
     {
-        for (int i = 0; i < set->numberOfItems; i++)
-        {
-            bool fl = false;
-            for (int j = 0; j < universe->numberOfItems; j++)
-                if ((fl = !strcmp(set->items[i], universe->items[j])))
-                    break;
-            if (!fl)
-            {
-                for (int i = 0; i < set->numberOfItems; i++)
-                {
-                    free(set->items[i]);
-                }
-                free(set->items);
-                free(set);
-                printf("14");
-                return ARGS_ERR;
-            }
-        }
+        parent[b] = a;
+        if (rank[a] == rank[b])
+            rank[a]++;
     }
-    return EXIT_SUCCESS;
 }
 
-// validates string relation
-int ValidatesStringRelation(char *str, void **ref, set_t *universe)
+// prints classes of elements connected by pairs of relation, or false if equivalence is required and relation isn't one
+static void __partition(rel_t *rel, set_t *universe, bool equivalence, int *errorCode)
 {
+    graph_t *graph;
+    int n = universe->numberOfItems;
+    int *parent;         // disjoint-set forest over universe indexes
+    unsigned char *rank; // upper bounds of heights of trees
+    long long *size;     // number of elements in class of each representative
+    long long *pairs;    // number of pairs inside class of each representative
+    int *first;          // first element of class of each representative
+    int *next;           // next element of the same class
+    int loops = 0;       // number of pairs (a a)
 
-    int length = strlen(str);
-    int errorCode = 0; // error code
-    bool fl;           // flag
+    if ((graph = __graph(rel, universe, errorCode)) == NULL)
+        return;
 
-    if (length == 1)
+    parent = malloc((n + 1) * sizeof(int));
+    rank = calloc(n + 1, sizeof(unsigned char));
+    size = calloc(n + 1, sizeof(long long));
+    pairs = calloc(n + 1, sizeof(long long));
+    first = malloc((n + 1) * sizeof(int));
+    next = malloc((n + 1) * sizeof(int));
+    if (parent == NULL || rank == NULL || size == NULL || pairs == NULL || first == NULL || next == NULL)
     {
-        *ref = SaveRelation(str, &errorCode); // creates a pointer to an object
+        free(parent);
+        free(rank);
+        free(size);
+        free(pairs);
+        free(first);
+        free(next);
+        *errorCode = MEMORY_ERR;
+        return;
+    }
 
-        return EXIT_SUCCESS;
+    for (int u = 0; u < n; u++)
+        parent[u] = u;
+    for (int u = 0; u < n; u++)
+        for (int k = graph->outStart[u]; k < graph->outStart[u + 1]; k++)
+        {
+            __unite(parent, rank, u, graph->outAdj[k]);
+            loops += (graph->outAdj[k] == u);
+        }
+
+    for (int u = 0; u < n; u++)
+        size[__find(parent, u)]++;
+    for (int u = 0; u < n; u++)
+        pairs[__find(parent, u)] += graph->outStart[u + 1] - graph->outStart[u];
+
+    // pairs are unique, so relation is an equivalence iff it's reflexive and every class is complete
+    bool fl = true;
+    if (equivalence)
+    {
+        fl = (loops == n);
+        for (int u = 0; u < n && fl; u++)
+            if (parent[u] == u && pairs[u] != size[u] * size[u])
+                fl = false;
     }
-    for (int i = 1; i < length; i++)
+
+    if (!fl)
+        fprintf(output, _FALSE);
+    else
     {
-        if ((str[i] == ' ' && str[i - 1] == ' ') || !((str[i] >= 'A' && str[i] <= 'Z') || (str[i] >= 'a' && str[i] <= 'z') || str[i] == ' ' || str[i] == '(' || str[i] == ')')) // if string has 2 spaces in a row
+        // links elements of each class in order of universe
+        for (int u = 0; u < n; u++)
+            first[u] = -1;
+        for (int u = n - 1; u >= 0; u--)
         {
-            errorCode = ARGS_ERR;
-            break;
+            int root = __find(parent, u);
+            next[u] = first[root];
+            first[root] = u;
+        }
+
+        fputc(PARTITION, output);
+        for (int u = 0; u < n; u++)
+        {
+            // prints class when its first element is reached, elements without pairs aren't in relation
+            if (first[__find(parent, u)] != u ||
+                (next[u] == -1 && graph->outStart[u + 1] == graph->outStart[u] && graph->inStart[u + 1] == graph->inStart[u]))
+                continue;
+            fputs(" (", output);
+            PrintName(universe, u);
+            for (int v = next[u]; v != -1; v = next[v])
+                PrintElement(universe, v);
+            fputc(')', output);
         }
     }
 
-    // if there is an error
-    if (errorCode)
-        return errorCode;
+    free(parent);
+    free(rank);
+    free(size);
+    free(pairs);
+    free(first);
+    free(next);
+}
 
-    *ref = SaveRelation(str, &errorCode); // creates a pointer to an object
+// Classes
+static void RelClasses(rel_t *rel, set_t *universe, int *errorCode)
+{
+    __partition(rel, universe, true, errorCode);
+}
 
-    rel_t *rel = (rel_t *)*ref;
+// Components
+static void RelComponents(rel_t *rel, set_t *universe, int *errorCode)
+{
+    __partition(rel, universe, false, errorCode);
+}
 
-    if (errorCode)
-        return errorCode;
-    // checks if relation has the same pairs
-    for (int i = 0; i < rel->numberOfPairs; i++)
+// returns element lying on a cycle or -1 (pairs (a a) are cycles only if loops is true)
+static int __onCycle(graph_t *graph, int *component, bool loops)
+{
+    for (int u = 0; u < graph->vertices; u++)
+        for (int k = graph->outStart[u]; k < graph->outStart[u + 1]; k++)
+            if (component[graph->outAdj[k]] == component[u] && (loops || graph->outAdj[k] != u))
+                return u;
+    return -1;
+}
+
+// prints pairs of a cycle reached from the element inside its component
+static void __printCycle(graph_t *graph, set_t *universe, int *component, int start, bool loops)
+{
+    int stamp = ++graph->stamp;
+    int length = 0;
+    int u = start;
+
+    // every element of a cyclic component has a successor in it, so the walk has to close a cycle
+    while (graph->seen[0][u] != stamp)
     {
-        for (int j = i + 1; j < rel->numberOfPairs; j++)
-        {
-            if (!strcmp(rel->pairs[i].elements[0], rel->pairs[j].elements[0]) &&
-                !strcmp(rel->pairs[i].elements[1], rel->pairs[j].elements[1]))
+        graph->seen[0][u] = stamp;
+        graph->dist[0][u] = length;
+        graph->queue[length++] = u;
+        for (int k = graph->outStart[u]; k < graph->outStart[u + 1]; k++)
+            if (component[graph->outAdj[k]] == component[u] && (loops || graph->outAdj[k] != u))
             {
-                free(rel->pairs);
-                free(rel);
-                return ARGS_ERR;
+                u = graph->outAdj[k];
+                break;
             }
-        }
     }
+    for (int i = graph->dist[0][u]; i < length; i++)
+        PrintPair(universe, graph->queue[i], i + 1 < length ? graph->queue[i + 1] : u);
+}
 
-    // checks if all the elements of pairs in relation are in universe
-    for (int i = 0; i < rel->numberOfPairs; i++)
-    {
-        for (int k = 0; k < PAIR; k++)
+/*
+ * Returns element u of pairs (u middle) and (middle last) whose composition (u last)
+ * is missing, or -1 if relation is transitive. Successors of middle are merged
+ * with successors of u, both lists are sorted.
+ */
+static int __intransitive(graph_t *graph, int *middle, int *last)
+{
+    for (int u = 0; u < graph->vertices; u++)
+        for (int k = graph->outStart[u]; k < graph->outStart[u + 1]; k++)
         {
-            fl = false;
-            for (int j = 0; j < universe->numberOfItems; j++)
+            int v = graph->outAdj[k];
+            int i = graph->outStart[u];
+            if (v == u)
+                continue;
+            for (int j = graph->outStart[v]; j < graph->outStart[v + 1]; j++)
             {
-                if ((fl = !strcmp(rel->pairs[i].elements[k], universe->items[j])))
+                while (i < graph->outStart[u + 1] && graph->outAdj[i] < graph->outAdj[j])
+                    i++;
+                if (i == graph->outStart[u + 1] || graph->outAdj[i] != graph->outAdj[j])
                 {
-                    break;
+                    *middle = v;
+                    *last = graph->outAdj[j];
+                    return u;
                 }
             }
-            if (!fl)
-            {
-
-                free(rel->pairs);
-                free(rel);
-                return ARGS_ERR;
-            }
         }
-    }
-    return EXIT_SUCCESS;
+    return -1;
 }
 
-// converts string into relation
-rel_t *SaveRelation(char *str, int *errorCode)
+/*
+ * Returns true or false if relation is a partial order
+ * On failure prints the first missing pair (a a), pairs of a cycle or two pairs
+ * whose composition is missing.
+ */
+static void RelPoset(rel_t *rel, set_t *universe, int *errorCode)
 {
-    char *pch;
-    rel_t *rel;
+    graph_t *graph;
+    int *component;
+    int u, v, w;
 
-    if (allocate(rel, sizeof(rel_t)))
+    if ((graph = __graph(rel, universe, errorCode)) == NULL || (component = __scc(graph, errorCode)) == NULL)
+        return;
+
+    // reflexive, successors are sorted, so (u u) is after the smaller ones
+    for (u = 0; u < graph->vertices; u++)
     {
-        *errorCode = MEMORY_ERR;
-        return NULL;
+        int k = graph->outStart[u];
+        while (k < graph->outStart[u + 1] && graph->outAdj[k] < u)
+            k++;
+        if (k == graph->outStart[u + 1] || graph->outAdj[k] != u)
+        {
+            fprintf(output, _FALSE);
+            PrintPair(universe, u, u);
+            free(component);
+            return;
+        }
     }
-    if (allocate(rel->pairs, sizeof(pair_t)))
+
+    // antisymmetric, no cycle other than (a a)
+    if ((u = __onCycle(graph, component, false)) != -1)
     {
-        *errorCode = MEMORY_ERR;
-        return NULL;
+        fprintf(output, _FALSE);
+        __printCycle(graph, universe, component, u, false);
+        free(component);
+        return;
     }
+    free(component);
 
-    void *error; // error pointer
+    // transitive, successors of successor are successors
+    if ((u = __intransitive(graph, &v, &w)) != -1)
+    {
+        fprintf(output, _FALSE);
+        PrintPair(universe, u, v);
+        PrintPair(universe, v, w);
+        return;
+    }
+    fprintf(output, _TRUE);
+}
 
-    pch = strtok(str, SPACE);
+/*
+ * Returns true or false if relation has no cycle
+ * On failure prints pairs of a cycle.
+ */
+static void RelAcyclic(rel_t *rel, set_t *universe, int *errorCode)
+{
+    graph_t *graph;
+    int *component;
+    int u;
 
-    int numOfElems = 0;     // number of pairs in relation
-    rel->numberOfPairs = 0; // resets number of pairs
+    if ((graph = __graph(rel, universe, errorCode)) == NULL || (component = __scc(graph, errorCode)) == NULL)
+        return;
 
-    while ((pch = strtok(NULL, SPACE)) != NULL)
+    if ((u = __onCycle(graph, component, true)) != -1)
     {
-        if (strlen(pch) - 1 > MAX_LENGTH)
-        {
-            *errorCode = ARGS_ERR;
-            break;
-        }
+        fprintf(output, _FALSE);
+        __printCycle(graph, universe, component, u, true);
+    }
+    else
+        fprintf(output, _TRUE);
+    free(component);
+}
 
-        if (numOfElems % 2 == 0)
-        {
-            // validates pair in relation
-            if (pch[0] != '(')
-            {
-                *errorCode = ARGS_ERR;
-                break;
-            }
-            strcpy(rel->pairs[rel->numberOfPairs].elements[0], pch);
+/*
+ * Prints elements of relation in topological order (pairs (a a) are ignored)
+ * If relation has a cycle, prints false and pairs of the cycle.
+ */
+static void RelToposort(rel_t *rel, set_t *universe, int *errorCode)
+{
+    graph_t *graph;
+    int *component;
+    int u;
 
-            // removes ( from the first element
-            for (int i = 0; i < (int)strlen(pch); i++)
-                rel->pairs[rel->numberOfPairs].elements[0][i] = rel->pairs[rel->numberOfPairs].elements[0][i + 1];
-            for (int i = 0; i < RESTRICTED_COUNT; i++)
-            {
-                if (!strcmp(RESTRICTED[i], rel->pairs[rel->numberOfPairs].elements[0]))
-                {
-                    *errorCode = ARGS_ERR;
-                    break;
-                }
-            }
-        }
-        else
-        {
-            // removes ) from the second element
-            if (pch[strlen(pch) - 1] != ')')
-            {
-                *errorCode = ARGS_ERR;
-                break;
-            }
-            strcpy(rel->pairs[rel->numberOfPairs].elements[1], pch);
-            rel->pairs[rel->numberOfPairs++].elements[1][strlen(pch) - 1] = '\0'; // delete the right bracket
+    if ((graph = __graph(rel, universe, errorCode)) == NULL || (component = __scc(graph, errorCode)) == NULL)
+        return;
 
-            for (int i = 0; i < RESTRICTED_COUNT; i++)
-            {
-                if (!strcmp(RESTRICTED[i], rel->pairs[rel->numberOfPairs - 1].elements[1]))
-                {
-                    *errorCode = ARGS_ERR;
-                    break;
-                }
-            }
-            // resizes pairs array
-            if (reallocate(error, rel->pairs, (rel->numberOfPairs + 1) * sizeof(pair_t)))
-            {
-                *errorCode = MEMORY_ERR;
-                break;
-            }
-            rel->pairs = error;
+    if ((u = __onCycle(graph, component, false)) != -1)
+    {
+        fprintf(output, _FALSE);
+        __printCycle(graph, universe, component, u, false);
+    }
+    else
+    {
+        // every component is a single element, components are numbered from the last one
+        for (u = 0; u < graph->vertices; u++)
+            graph->queue[graph->vertices - 1 - component[u]] = u;
+        PrintTag(SETCAL_FRAME_LIST); // order of elements is the result
+        for (int i = 0; i < graph->vertices; i++)
+        {
+            u = graph->queue[i];
+            if (graph->outStart[u + 1] != graph->outStart[u] || graph->inStart[u + 1] != graph->inStart[u])
+                PrintElement(universe, u);
         }
-        numOfElems++;
     }
+    free(component);
+}
+
+// library
 
-    // if there was an error
-    if (*errorCode)
+const char *SetcalErrorMessage(int error)
+{
+    return ErrorMessage(error);
+}
+
+model_t *SetcalLoad(FILE *fp, int *errorCode)
+{
+    model_t *model;
+
+    if (allocate(model, sizeof(model_t)))
     {
-        free(rel->pairs);
-        free(rel);
+        *errorCode = MEMORY_ERR;
         return NULL;
     }
-
-    return rel;
+    if ((*errorCode = LoadModel(fp, model)))
+    {
+        free(model);
+        return NULL;
+    }
+    return model;
 }
 
-// calculates sets & rels
-void ProcessCal(line_t *lines, char *str, int *errorCode)
+model_t *SetcalOpen(const char *path, int *errorCode)
 {
-    int num;     // temp argument
-    char *pch;   // pointer for strtok
-    void *error; // error pointer
+    model_t *model;
+    FILE *fp;
 
-    cal_t cal; // object for expressions
+    if ((fp = fopen(path, FILEMODE)) == NULL)
+    {
+        *errorCode = FILE_ERR;
+        return NULL;
+    }
+    model = SetcalLoad(fp, errorCode);
+    fclose(fp);
+    return model;
+}
 
-    cal.argumentsCount = 0; // resets argument count
+void SetcalClose(model_t *model)
+{
+    if (model == NULL)
+        return;
+    FreeLines(model->lines, model->numberOfLines, false);
+    free(model);
+}
 
-    pch = strtok(str, SPACE);
+set_t *SetcalSet(model_t *model, int line)
+{
+    if (line < 1 || line > model->numberOfLines || model->lines[line - 1].type != SET)
+        return NULL;
+    return (set_t *)model->lines[line - 1].ref;
+}
 
-    if ((pch = strtok(NULL, SPACE)) != NULL)
-    {
-        if (allocate(cal.operation, strlen(pch) + 1)) // allocates memory for operation string
-        {
-            *errorCode = MEMORY_ERR;
-            return;
-        }
-        strcpy(cal.operation, pch);
-    }
+rel_t *SetcalRelation(model_t *model, int line)
+{
+    if (line < 1 || line > model->numberOfLines || model->lines[line - 1].type != RELATION)
+        return NULL;
+    return (rel_t *)model->lines[line - 1].ref;
+}
 
-    if (allocate(cal.arguments, sizeof(int))) // allocates memory for arguments
+int SetcalQuery(model_t *model, const char *command, char *buffer, int size, int *errorCode)
+{
+    char *copy;   // command is split by strtok_r
+    char *result; // result of command
+    int length;
+
+    *errorCode = 0;
+    if (size > 0) // buffer is empty if command fails
+        buffer[0] = '\0';
+    if (allocate(copy, strlen(command) + 1))
     {
         *errorCode = MEMORY_ERR;
-        return;
+        return 0;
     }
+    strcpy(copy, command);
+    result = Execute(model, copy, errorCode);
+    free(copy);
+    if (result == NULL)
+        return 0;
 
-    // reads arguments of the command
-    while ((pch = strtok(NULL, SPACE)) != NULL)
-    {
-        if ((num = atoi(pch)) != 0)
-        {
-            cal.arguments[cal.argumentsCount++] = num;
-            if (reallocate(error, cal.arguments, (cal.argumentsCount + 1) * sizeof(int *)))
-            {
-                *errorCode = MEMORY_ERR;
-                break;
-            }
-            cal.arguments = error;
-        }
-    }
-
-    // command execution
-    if (!strcmp(cal.operation, EMPTY) && (cal.argumentsCount == 1) && ((lines[cal.arguments[0] - 1].type == SET)))
-        SetEmpty((set_t *)(lines[cal.arguments[0] - 1].ref));
-    else if (!strcmp(cal.operation, COMPLEMENT) && (cal.argumentsCount == 1) && ((lines[cal.arguments[0] - 1].type == SET)))
-        SetComplement((set_t *)(lines[cal.arguments[0] - 1].ref), (set_t *)(lines[0].ref));
-    else if (!strcmp(cal.operation, CARD) && (cal.argumentsCount == 1) && ((lines[cal.arguments[0] - 1].type == SET)))
-        SetCard((set_t *)(lines[cal.arguments[0] - 1].ref));
-    else if (!strcmp(cal.operation, UNION) && (cal.argumentsCount == 2) && ((lines[cal.arguments[0] - 1].type == SET)) && (lines[cal.arguments[1] - 1].type == SET))
-        SetUnion((set_t *)(lines[cal.arguments[0] - 1].ref), (set_t *)(lines[cal.arguments[1] - 1].ref));
-    else if (!strcmp(cal.operation, INTERSECT) && (cal.argumentsCount == 2) && ((lines[cal.arguments[0] - 1].type == SET)) && (lines[cal.arguments[1] - 1].type == SET))
-        SetIntersect((set_t *)(lines[cal.arguments[0] - 1].ref), (set_t *)(lines[cal.arguments[1] - 1].ref));
-    else if (!strcmp(cal.operation, MINUS) && (cal.argumentsCount == 2) && ((lines[cal.arguments[0] - 1].type == SET)) && (lines[cal.arguments[1] - 1].type == SET))
-        SetMinus((set_t *)(lines[cal.arguments[0] - 1].ref), (set_t *)(lines[cal.arguments[1] - 1].ref));
-    else if (!strcmp(cal.operation, SUBSETEQ) && (cal.argumentsCount == 2) && ((lines[cal.arguments[0] - 1].type == SET)) && (lines[cal.arguments[1] - 1].type == SET))
-        SetSubseteq((set_t *)(lines[cal.arguments[0] - 1].ref), (set_t *)(lines[cal.arguments[1] - 1].ref));
-    else if (!strcmp(cal.operation, SUBSET) && (cal.argumentsCount == 2) && ((lines[cal.arguments[0] - 1].type == SET)) && (lines[cal.arguments[1] - 1].type == SET))
-        SetSubset((set_t *)(lines[cal.arguments[0] - 1].ref), (set_t *)(lines[cal.arguments[1] - 1].ref));
-    else if (!strcmp(cal.operation, EQUALS) && (cal.argumentsCount == 2) && ((lines[cal.arguments[0] - 1].type == SET)) && (lines[cal.arguments[1] - 1].type == SET))
-        SetEquals((set_t *)(lines[cal.arguments[0] - 1].ref), (set_t *)(lines[cal.arguments[1] - 1].ref));
-    else if (!strcmp(cal.operation, REFLEXIVE) && (cal.argumentsCount == 1) && (lines[cal.arguments[0] - 1].type == RELATION))
-        RelReflexive((rel_t *)(lines[cal.arguments[0] - 1].ref), (set_t *)(lines[0].ref));
-    else if (!strcmp(cal.operation, SYMMETRIC) && (cal.argumentsCount == 1) && (lines[cal.arguments[0] - 1].type == RELATION))
-        RelSymmetric((rel_t *)(lines[cal.arguments[0] - 1].ref));
-    else if (!strcmp(cal.operation, ANTISYMMETRIC) && (cal.argumentsCount == 1) && (lines[cal.arguments[0] - 1].type == RELATION))
-        RelAntisymmetric((rel_t *)(lines[cal.arguments[0] - 1].ref));
-    else if (!strcmp(cal.operation, TRANSITIVE) && (cal.argumentsCount == 1) && (lines[cal.arguments[0] - 1].type == RELATION))
-        RelTransitive((rel_t *)(lines[cal.arguments[0] - 1].ref));
-    else if (!strcmp(cal.operation, FUNCTION) && (cal.argumentsCount == 1) && (lines[cal.arguments[0] - 1].type == RELATION))
-        RelFunction((rel_t *)(lines[cal.arguments[0] - 1].ref), (set_t *)(lines[0].ref));
-    else if (!strcmp(cal.operation, DOMAIN) && (cal.argumentsCount == 1) && (lines[cal.arguments[0] - 1].type == RELATION))
-        RelDomain((rel_t *)(lines[cal.arguments[0] - 1].ref), (set_t *)(lines[0].ref));
-    else if (!strcmp(cal.operation, CODOMAIN) && (cal.argumentsCount == 1) && (lines[cal.arguments[0] - 1].type == RELATION))
-        RelCodomain((rel_t *)(lines[cal.arguments[0] - 1].ref), (set_t *)(lines[0].ref));
-    else if (!strcmp(cal.operation, INJECTIVE) && (cal.argumentsCount == 3) && (lines[cal.arguments[0] - 1].type == RELATION))
-        RelInjective((rel_t *)(lines[cal.arguments[0] - 1].ref), (set_t *)(lines[cal.arguments[1] - 1].ref), (set_t *)(lines[cal.arguments[2] - 1].ref));
-    else if (!strcmp(cal.operation, SURJECTIVE) && (cal.argumentsCount == 3) && (lines[cal.arguments[0] - 1].type == RELATION))
-        RelSurjective((rel_t *)(lines[cal.arguments[0] - 1].ref), (set_t *)(lines[cal.arguments[1] - 1].ref), (set_t *)(lines[cal.arguments[2] - 1].ref));
-    else if (!strcmp(cal.operation, BIJECTIVE) && (cal.argumentsCount == 3) && (lines[cal.arguments[0] - 1].type == RELATION))
-        RelBijective((rel_t *)(lines[cal.arguments[0] - 1].ref), (set_t *)(lines[cal.arguments[1] - 1].ref), (set_t *)(lines[cal.arguments[2] - 1].ref));
-    else
+    length = strlen(result);
+    if (size > 0)
     {
-        free(cal.operation);
-        free(cal.arguments);
-        *errorCode = ARGS_ERR;
-        return;
+        int count = length < size - 1 ? length : size - 1;
+        memcpy(buffer, result, count);
+        buffer[count] = '\0';
     }
+    free(result);
+    return length;
+}
 
-    free(cal.operation);
-    free(cal.arguments);
+int SetcalIndex(model_t *model, const char *element)
+{
+    return __indexOf((set_t *)model->lines[0].ref, element);
 }
 
-// returns true if set is empty
-void SetEmpty(set_t *set)
+const char *SetcalElement(model_t *model, int index)
 {
-    printf((set->numberOfItems) ? _FALSE : _TRUE);
+    set_t *universe = (set_t *)model->lines[0].ref;
+    return (index >= 0 && index < universe->numberOfItems) ? universe->items[index] : NULL;
 }
 
-// returns number of elements from set
-void SetCard(set_t *set)
+int SetcalCard(set_t *set)
 {
-    printf("%d", set->numberOfItems);
+    return set->numberOfItems;
 }
 
-// component for Minus
-void __minus(set_t *set1, set_t *set2)
+int SetcalElements(set_t *set, int *ids)
 {
-    bool fl;
-    for (int i = 0; i < set1->numberOfItems; i++)
-    {
-        fl = true;
-        for (int j = 0; j < set2->numberOfItems; j++)
-        {
-            if (strcmp(set2->items[j], set1->items[i]) == 0)
-            {
-                fl = false;
-                break;
-            }
-        }
-        if (fl)
-            printf(" %s", set1->items[i]);
-    }
+    memcpy(ids, set->ids, set->numberOfItems * sizeof(int));
+    return set->numberOfItems;
 }
 
-// component for Complement
-void __complement(set_t *set1, set_t *set2)
+int SetcalComplement(model_t *model, set_t *set, int *ids)
 {
-    if (set1->numberOfItems != 0)
-    {
-        __minus(set2, set1);
-    }
-    else
-    {
-        for (int i = 0; i < set2->numberOfItems; i++)
-        {
-            printf(" %s", set2->items[i]);
-        }
-    }
+    return __complement(set, (set_t *)model->lines[0].ref, ids);
 }
 
-// Complement
-void SetComplement(set_t *set, set_t *universe)
+int SetcalUnion(set_t *set1, set_t *set2, int *ids)
 {
-    putchar(SET);
-    __complement(set, universe);
+    return __union(set1, set2, ids);
 }
 
-// Union
-void SetUnion(set_t *set1, set_t *set2)
+int SetcalIntersect(set_t *set1, set_t *set2, int *ids)
 {
-    putchar(SET);
-    for (int i = 0; i < set1->numberOfItems; i++)
-        printf(" %s", set1->items[i]);
-    __complement(set1, set2);
+    return __intersect(set1, set2, ids);
 }
 
-// Intersect
-void SetIntersect(set_t *set1, set_t *set2)
+int SetcalMinus(set_t *set1, set_t *set2, int *ids)
 {
-    putchar(SET);
-    for (int i = 0; i < set1->numberOfItems; i++)
-        for (int j = 0; j < set2->numberOfItems; j++)
-            if (!strcmp(set1->items[i], set2->items[j]))
-                printf(" %s", set1->items[i]);
+    return __minus(set1, set2, ids);
 }
 
-// Minus
-void SetMinus(set_t *set1, set_t *set2)
+bool SetcalSubseteq(set_t *set1, set_t *set2)
 {
-    putchar(SET);
-    __minus(set1, set2);
+    return __subseteq(set1, set2);
 }
 
-// Subseteq
-void SetSubseteq(set_t *set1, set_t *set2)
+bool SetcalSubset(set_t *set1, set_t *set2)
 {
-    bool fl;
-    if (set1->numberOfItems == 0)
-    {
-        printf(_TRUE);
-        return;
-    }
-    if (set2->numberOfItems == 0)
-    {
-        printf(_FALSE);
-        return;
-    }
-    for (int i = 0; i < set1->numberOfItems; i++)
-    {
-        fl = true;
-        for (int j = 0; j < set2->numberOfItems; j++)
-        {
-            if (strcmp(set2->items[j], set1->items[i]) == 0)
-            {
-                fl = false;
-                break;
-            }
-        }
-        if (fl)
-        {
-            printf(_FALSE);
-            return;
-        }
-    }
-    printf(_TRUE);
+    return __subset(set1, set2);
 }
-// Subset
-void SetSubset(set_t *set1, set_t *set2)
+
+bool SetcalEquals(set_t *set1, set_t *set2)
 {
-    bool fl;
-    if (set2->numberOfItems == 0)
-    {
-        printf(_FALSE);
-        return;
-    }
-    if (set1->numberOfItems == 0)
-    {
-        printf(_TRUE);
-        return;
-    }
+    return __equals(set1, set2);
+}
 
-    for (int i = 0; i < set1->numberOfItems; i++)
-    {
-        fl = true;
-        for (int j = 0; j < set2->numberOfItems; j++)
-        {
-            if (strcmp(set2->items[j], set1->items[i]) == 0)
-            {
-                fl = false;
-                break;
-            }
-        }
-        if (fl)
-        {
-            printf(_FALSE);
-            return;
-        }
-    }
-    if (set2->numberOfItems == set1->numberOfItems)
-        printf(_FALSE);
-    else
-        printf(_TRUE);
+bool SetcalReflexive(model_t *model, rel_t *rel)
+{
+    return __reflexive(rel, (set_t *)model->lines[0].ref);
 }
 
-// Equals
-void SetEquals(set_t *set1, set_t *set2)
+bool SetcalSymmetric(model_t *model, rel_t *rel, int *errorCode)
 {
-    bool fl;
+    return __symmetric(rel, (set_t *)model->lines[0].ref, errorCode);
+}
 
-    if (set2->numberOfItems == 0 && set1->numberOfItems == 0)
-    {
-        printf(_TRUE);
-        return;
-    }
-    if (set2->numberOfItems != set1->numberOfItems)
-    {
-        printf(_FALSE);
-        return;
-    }
-    for (int i = 0; i < set1->numberOfItems; i++)
-    {
-        fl = false;
-        for (int j = 0; j < set2->numberOfItems; j++)
-            if ((fl = !strcmp(set2->items[j], set1->items[i])))
-                break;
-        if (!fl)
-        {
-            printf(_FALSE);
-            return;
-        }
-    }
-    printf(_TRUE);
+bool SetcalAntisymmetric(model_t *model, rel_t *rel, int *errorCode)
+{
+    return __antisymmetric(rel, (set_t *)model->lines[0].ref, errorCode);
 }
 
-// Reflexive
-void RelReflexive(rel_t *rel, set_t *universe)
+bool SetcalTransitive(model_t *model, rel_t *rel, int *errorCode)
 {
-    int count = 0;
-    for (int i = 0; i < rel->numberOfPairs; i++)
-        if (strcmp(rel->pairs[i].elements[0], rel->pairs[i].elements[1]) == 0)
-            count++;
-    if (count == universe->numberOfItems)
-        printf(_TRUE);
-    else
-        printf(_FALSE);
+    return __transitive(rel, (set_t *)model->lines[0].ref, errorCode);
 }
 
-// Symmetric
-void RelSymmetric(rel_t *rel)
+bool SetcalFunction(model_t *model, rel_t *rel, int *errorCode)
 {
-    bool fl;
-    for (int i = 0; i < (rel->numberOfPairs); i++)
-    {
-        if (strcmp(rel->pairs[i].elements[0], rel->pairs[i].elements[1]) == 0)
-        {
-            continue;
-        }
-        fl = true;
+    return __func(rel, (set_t *)model->lines[0].ref, errorCode);
+}
 
-        for (int j = 0; j < rel->numberOfPairs; j++)
-        {
-            if ((strcmp(rel->pairs[i].elements[0], rel->pairs[j].elements[1]) == 0) && (strcmp(rel->pairs[i].elements[1], rel->pairs[j].elements[0]) == 0))
-            {
-                fl = false;
-                break;
-            }
-        }
-        if (fl)
-        {
-            printf(_FALSE);
-            return;
-        }
-    }
-    printf(_TRUE);
+int SetcalDomain(model_t *model, rel_t *rel, int *ids)
+{
+    return __domain(rel, (set_t *)model->lines[0].ref, 0, ids);
 }
 
-/*
- * Returns true or false if relation is Antisymmetric
- *
- */
-void RelAntisymmetric(rel_t *rel)
+int SetcalCodomain(model_t *model, rel_t *rel, int *ids)
 {
-    for (int i = 0; i < (rel->numberOfPairs); i++)
-    {
-        if (strcmp(rel->pairs[i].elements[0], rel->pairs[i].elements[1]) == 0)
-        {
-            continue;
-        }
-        for (int j = 0; j < rel->numberOfPairs; j++)
-        {
-            if ((strcmp(rel->pairs[i].elements[0], rel->pairs[j].elements[1]) == 0) && (strcmp(rel->pairs[i].elements[1], rel->pairs[j].elements[0]) == 0))
-            {
-                printf(_FALSE);
-                return;
-            }
-        }
-    }
-    printf(_TRUE);
+    return __domain(rel, (set_t *)model->lines[0].ref, 1, ids);
 }
 
-/*
- * Returns true or false if relation is Transitive
- *
- */
-void RelTransitive(rel_t *rel)
+bool SetcalInjective(rel_t *rel, set_t *set1, set_t *set2, int *errorCode)
 {
-    bool fl;
-    for (int i = 0; i < (rel->numberOfPairs); i++)
-    {
-        if (strcmp(rel->pairs[i].elements[0], rel->pairs[i].elements[1]) == 0)
-        {
-            continue;
-        }
-        for (int j = 0; j < rel->numberOfPairs; j++)
-            if (strcmp(rel->pairs[i].elements[1], rel->pairs[j].elements[0]) == 0)
-            {
-                fl = true;
-                for (int k = 0; k < rel->numberOfPairs; k++)
-                    if (((strcmp(rel->pairs[i].elements[0], rel->pairs[k].elements[0]) == 0) && (strcmp(rel->pairs[j].elements[1], rel->pairs[k].elements[1]) == 0)))
-                    {
-                        fl = false;
-                        break;
-                    }
-                if (fl)
-                {
-                    printf(_FALSE);
-                    return;
-                }
-            }
-    }
-    printf(_TRUE);
+    return __injective(rel, set1, set2, errorCode);
 }
 
-bool __func(rel_t *rel, set_t *universe)
+bool SetcalSurjective(rel_t *rel, set_t *set1, set_t *set2, int *errorCode)
 {
-    int count;
-    for (int i = 0; i < (universe->numberOfItems); i++)
-    {
-        count = 0;
-        for (int j = 0; j < rel->numberOfPairs; j++)
-        {
-            if (strcmp(universe->items[i], rel->pairs[j].elements[0]) == 0)
-                count++;
-        }
-        if (count > 1)
-        {
-            return false;
-        }
-    }
-    return true;
+    return __surjective(rel, set1, set2, errorCode);
 }
 
-// Function
-void RelFunction(rel_t *rel, set_t *universe)
+bool SetcalBijective(rel_t *rel, set_t *set1, set_t *set2, int *errorCode)
 {
-    printf(__func(rel, universe) ? _TRUE : _FALSE);
+    return __bijective(rel, set1, set2, errorCode);
 }
 
-// Domain
-void RelDomain(rel_t *rel, set_t *universe)
+bool SetcalReach(model_t *model, rel_t *rel, int from, int to, int *errorCode)
 {
-    putchar(SET);
-    for (int i = 0; i < universe->numberOfItems; i++)
+    graph_t *graph;
+    set_t *universe = (set_t *)model->lines[0].ref;
+
+    if (from < 0 || to < 0 || from >= universe->numberOfItems || to >= universe->numberOfItems)
     {
-        for (int j = 0; j < rel->numberOfPairs; j++)
-        {
-            if (strcmp(universe->items[i], rel->pairs[j].elements[0]) == 0)
-            {
-                printf(" %s", universe->items[i]);
-                break;
-            }
-        }
+        *errorCode = ARGS_ERR;
+        return false;
     }
+    if ((graph = __graph(rel, universe, errorCode)) == NULL)
+        return false;
+    return __reaches(graph, from, to);
 }
 
-// Codomain
-void RelCodomain(rel_t *rel, set_t *universe)
+int SetcalDistance(model_t *model, rel_t *rel, int from, int to, int *errorCode)
 {
-    putchar(SET);
-    for (int i = 0; i < universe->numberOfItems; i++)
+    graph_t *graph;
+    set_t *universe = (set_t *)model->lines[0].ref;
+
+    if (from < 0 || to < 0 || from >= universe->numberOfItems || to >= universe->numberOfItems)
     {
-        for (int j = 0; j < rel->numberOfPairs; j++)
-        {
-            if (strcmp(universe->items[i], rel->pairs[j].elements[1]) == 0)
-            {
-                printf(" %s", universe->items[i]);
-                break;
-            }
-        }
+        *errorCode = ARGS_ERR;
+        return -1;
     }
+    if ((graph = __graph(rel, universe, errorCode)) == NULL)
+        return -1;
+    return __distance(graph, from, to);
 }
 
-// component of injective function
-bool __inject(rel_t *rel, set_t *set1, set_t *set2)
+int SetcalReadFrame(FILE *fp, char *type, uint8_t **data, int *length)
 {
-    if (__func(rel, set1))
+    unsigned size = 0;
+    int ch = fgetc(fp);
+    void *error;
+
+    if (ch == EOF)
+        return 0;
+    for (int shift = 0;; shift += 7)
     {
-        int count;
-        for (int i = 0; i < (set2->numberOfItems); i++)
-        {
-            count = 0;
-            for (int j = 0; j < rel->numberOfPairs; j++)
-            {
-                if (strcmp(set2->items[i], rel->pairs[j].elements[1]) == 0)
-                    count++;
-            }
-            if (count > 1)
-            {
-                return false;
-            }
-        }
-        return true;
+        if (ch == EOF || shift > 28)
+            return -1;
+        size |= (unsigned)(ch & 0x7f) << shift;
+        if (!(ch & 0x80))
+            break;
+        ch = fgetc(fp);
     }
-    return false;
+    if (size < 1 || size > INT32_MAX || (ch = fgetc(fp)) == EOF)
+        return -1;
+    *type = ch;
+    *length = size - 1;
+    if (reallocate(error, *data, *length + 1))
+        return -1;
+    *data = error;
+    return fread(*data, 1, *length, fp) == (size_t)*length ? 1 : -1;
 }
 
-bool __inSet(rel_t *rel, set_t *set, int numberOfElement)
+int SetcalFrameIds(char type, const uint8_t *data, int length, int *ids)
 {
-    bool fl;
-    for (int i = 0; i < rel->numberOfPairs; i++)
+    int count = 0;
+    int k = 0;
+    bool gaps = type == SETCAL_FRAME_SET; // sets store gaps from the previous id
+
+    if (type != SETCAL_FRAME_SET && type != SETCAL_FRAME_LIST && type != SETCAL_FRAME_RELATION)
+        return -1;
+    if (type == SETCAL_FRAME_SET)
+    {
+        if (length < 1)
+            return -1;
+        if (data[k++] == SETCAL_FRAME_BITSET)
+        {
+            for (; k < length; k++)
+                for (int bit = 0; bit < 8; bit++)
+                    if (data[k] >> bit & 1)
+                        ids[count++] = 8 * (k - 1) + bit;
+            return count;
+        }
+    }
+    while (k < length)
     {
-        for (int j = 0; j < set->numberOfItems; j++)
+        unsigned value = 0;
+        for (int shift = 0;; shift += 7)
         {
-            if ((fl = !strcmp(rel->pairs[i].elements[numberOfElement], set->items[j])))
+            if (k == length || shift > 28)
+                return -1;
+            value |= (unsigned)(data[k] & 0x7f) << shift;
+            if (!(data[k++] & 0x80))
                 break;
         }
-        if (!fl)
-            return false;
+        ids[count] = (int)value + (gaps && count ? ids[count - 1] : 0);
+        count++;
     }
-    return true;
-}
-
-void RelInjective(rel_t *rel, set_t *set1, set_t *set2)
-{
-    if ((__inSet(rel, set1, 0) && (__inSet(rel, set2, 1))))
-        printf(__inject(rel, set1, set2) ? _TRUE : _FALSE);
-    else
-        printf(_FALSE);
-}
-
-void RelSurjective(rel_t *rel, set_t *set1, set_t *set2)
-{
-    if ((__inSet(rel, set1, 0) && (__inSet(rel, set2, 1) && (__func(rel, set1)))))
-        printf(_TRUE);
-    else
-        printf(_FALSE);
+    return count;
 }
-
-void RelBijective(rel_t *rel, set_t *set1, set_t *set2)
-{
-    if ((__inSet(rel, set1, 0) && (__inSet(rel, set2, 1))))
-        printf(__inject(rel, set1, set2) ? _TRUE : _FALSE);
-    else
-        printf(_FALSE);
-}
\ No newline at end of file
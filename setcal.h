@@ -0,0 +1,86 @@
+#ifndef SETCAL_H
+#define SETCAL_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Set Calculator as a library
+ *
+ * A model is a loaded file (universe, sets and relations), sets and relations are
+ * handles to its lines. Elements are universe indexes (0 is the first element of
+ * universe). Functions which produce a set write indexes of its elements into ids
+ * provided by caller and return their number. Different models can be used by
+ * different threads at once, but one model mustn't be used by more threads at once.
+ */
+
+enum SETCAL_ERROR // error codes
+{
+    SETCAL_MEMORY_ERR = 1,
+    SETCAL_ARGS_ERR,
+    SETCAL_FILE_ERR
+};
+
+// handles of a model and its lines, their structures are private to the library
+typedef struct setcal_model setcal_model_t;
+typedef struct setcal_set setcal_set_t;
+typedef struct setcal_rel setcal_rel_t;
+
+// frames of --output=binary: varint length of type and payload, type and payload (varints have 7 bits in each byte)
+#define SETCAL_FRAME_UNIVERSE 'U' // names of elements, each as varint length and chars
+#define SETCAL_FRAME_SET 'S'      // SETCAL_FRAME_GAPS and varint gaps between sorted ids, or SETCAL_FRAME_BITSET and bitset of ids
+#define SETCAL_FRAME_LIST 'L'     // varint ids in order of result (toposort)
+#define SETCAL_FRAME_RELATION 'R' // varint ids of the first and the second element of each pair
+#define SETCAL_FRAME_TEXT 'T'     // line as text, elements are written as '#' and their ids
+#define SETCAL_FRAME_ERROR 'E'    // error message
+#define SETCAL_FRAME_GAPS 0
+#define SETCAL_FRAME_BITSET 1
+
+// returns error message
+const char *SetcalErrorMessage(int error);
+
+// model
+setcal_model_t *SetcalOpen(const char *path, int *errorCode);
+setcal_model_t *SetcalLoad(FILE *fp, int *errorCode);
+void SetcalClose(setcal_model_t *model);
+setcal_set_t *SetcalSet(setcal_model_t *model, int line);      // NULL if line isn't a set (line 1 is universe)
+setcal_rel_t *SetcalRelation(setcal_model_t *model, int line); // NULL if line isn't a relation
+// executes command line ("C union 2 3") and writes its result as setcal prints it into buffer,
+// returns length of the whole result (at most size - 1 chars are written)
+int SetcalQuery(setcal_model_t *model, const char *command, char *buffer, int size, int *errorCode);
+
+// elements
+int SetcalIndex(setcal_model_t *model, const char *element); // -1 if element isn't in universe
+const char *SetcalElement(setcal_model_t *model, int index);
+
+// sets (ids of union needs room for both sets, complement for the whole universe)
+int SetcalCard(setcal_set_t *set);
+int SetcalElements(setcal_set_t *set, int *ids);
+int SetcalComplement(setcal_model_t *model, setcal_set_t *set, int *ids);
+int SetcalUnion(setcal_set_t *set1, setcal_set_t *set2, int *ids);
+int SetcalIntersect(setcal_set_t *set1, setcal_set_t *set2, int *ids);
+int SetcalMinus(setcal_set_t *set1, setcal_set_t *set2, int *ids);
+bool SetcalSubseteq(setcal_set_t *set1, setcal_set_t *set2);
+bool SetcalSubset(setcal_set_t *set1, setcal_set_t *set2);
+bool SetcalEquals(setcal_set_t *set1, setcal_set_t *set2);
+
+// relations (ids of domain and codomain needs room for the whole universe)
+bool SetcalReflexive(setcal_model_t *model, setcal_rel_t *rel);
+bool SetcalSymmetric(setcal_model_t *model, setcal_rel_t *rel, int *errorCode);
+bool SetcalAntisymmetric(setcal_model_t *model, setcal_rel_t *rel, int *errorCode);
+bool SetcalTransitive(setcal_model_t *model, setcal_rel_t *rel, int *errorCode);
+bool SetcalFunction(setcal_model_t *model, setcal_rel_t *rel, int *errorCode);
+int SetcalDomain(setcal_model_t *model, setcal_rel_t *rel, int *ids);
+int SetcalCodomain(setcal_model_t *model, setcal_rel_t *rel, int *ids);
+bool SetcalInjective(setcal_rel_t *rel, setcal_set_t *set1, setcal_set_t *set2, int *errorCode);
+bool SetcalSurjective(setcal_rel_t *rel, setcal_set_t *set1, setcal_set_t *set2, int *errorCode);
+bool SetcalBijective(setcal_rel_t *rel, setcal_set_t *set1, setcal_set_t *set2, int *errorCode);
+bool SetcalReach(setcal_model_t *model, setcal_rel_t *rel, int from, int to, int *errorCode);
+int SetcalDistance(setcal_model_t *model, setcal_rel_t *rel, int from, int to, int *errorCode); // -1 if to isn't reachable
+
+// frames (*data is reallocated for each frame, it's freed by caller)
+int SetcalReadFrame(FILE *fp, char *type, uint8_t **data, int *length); // 1 if frame was read, 0 at end, -1 if it's broken
+int SetcalFrameIds(char type, const uint8_t *data, int length, int *ids); // ids of set, list or relation frame (room for 8 * length)
+
+#endif